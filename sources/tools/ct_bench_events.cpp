@@ -0,0 +1,243 @@
+// ct-bench-events: times the conversion of the parameter values which the
+// plugin outputs, `event_converter_clap_to_v3::transfer`, with the dummy
+// plugin at growing numbers of parameters
+//
+// usage: ct-bench-events [-n iterations]
+
+#include "ct_dummy_plugin.hpp"
+#include "v3/ct_component.hpp"
+#include "v3/ct_events.hpp"
+#include "v3/ct_event_conversion.hpp"
+#include "v3/travesty_helpers.hpp"
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace ct;
+
+//------------------------------------------------------------------------------
+// the output parameter changes of a host, preallocated for all parameters
+
+struct fake_param_queue {
+    v3::param_value_queue::vtable *m_vptr = &s_vtable;
+    v3_param_id m_id = 0;
+    int32_t m_count = 0;
+    int32_t m_offsets[4] = {};
+    double m_values[4] = {};
+
+    static v3::param_value_queue::vtable s_vtable;
+};
+
+struct fake_param_changes {
+    v3::param_changes::vtable *m_vptr = &s_vtable;
+    std::unique_ptr<fake_param_queue[]> m_queues;
+    int32_t m_capacity = 0;
+    int32_t m_count = 0;
+
+    explicit fake_param_changes(uint32_t capacity)
+        : m_queues{new fake_param_queue[capacity]},
+          m_capacity{(int32_t)capacity}
+    {
+    }
+
+    void clear() noexcept { m_count = 0; }
+
+    static v3::param_changes::vtable s_vtable;
+};
+
+static v3_result V3_API fake_query_interface(void *, const v3_tuid, void **obj)
+{
+    *obj = nullptr;
+    return V3_NO_INTERFACE;
+}
+
+static uint32_t V3_API fake_ref(void *) { return 1; }
+static uint32_t V3_API fake_unref(void *) { return 1; }
+
+static v3_param_id V3_API fake_queue_get_param_id(void *self)
+{
+    return ((fake_param_queue *)self)->m_id;
+}
+
+static int32_t V3_API fake_queue_get_point_count(void *self)
+{
+    return ((fake_param_queue *)self)->m_count;
+}
+
+static v3_result V3_API fake_queue_get_point(void *self_, int32_t idx, int32_t *offset, double *value)
+{
+    fake_param_queue *self = (fake_param_queue *)self_;
+    if (idx < 0 || idx >= self->m_count)
+        return V3_INVALID_ARG;
+    *offset = self->m_offsets[idx];
+    *value = self->m_values[idx];
+    return V3_OK;
+}
+
+// keeps the last points, the count is what matters here
+static v3_result V3_API fake_queue_add_point(void *self_, int32_t offset, double value, int32_t *idx)
+{
+    fake_param_queue *self = (fake_param_queue *)self_;
+    int32_t index = self->m_count++ & 3;
+    self->m_offsets[index] = offset;
+    self->m_values[index] = value;
+    *idx = index;
+    return V3_OK;
+}
+
+v3::param_value_queue::vtable fake_param_queue::s_vtable = {
+    {&fake_query_interface, &fake_ref, &fake_unref},
+    {&fake_queue_get_param_id, &fake_queue_get_point_count, &fake_queue_get_point, &fake_queue_add_point},
+};
+
+static int32_t V3_API fake_changes_get_param_count(void *self)
+{
+    return ((fake_param_changes *)self)->m_count;
+}
+
+static v3_param_value_queue **V3_API fake_changes_get_param_data(void *self_, int32_t idx)
+{
+    fake_param_changes *self = (fake_param_changes *)self_;
+    if (idx < 0 || idx >= self->m_count)
+        return nullptr;
+    return (v3_param_value_queue **)&self->m_queues[idx];
+}
+
+static v3_param_value_queue **V3_API fake_changes_add_param_data(void *self_, v3_param_id *id, int32_t *index)
+{
+    fake_param_changes *self = (fake_param_changes *)self_;
+    if (self->m_count == self->m_capacity)
+        return nullptr;
+    fake_param_queue *queue = &self->m_queues[self->m_count];
+    queue->m_id = *id;
+    queue->m_count = 0;
+    *index = self->m_count++;
+    return (v3_param_value_queue **)queue;
+}
+
+v3::param_changes::vtable fake_param_changes::s_vtable = {
+    {&fake_query_interface, &fake_ref, &fake_unref},
+    {&fake_changes_get_param_count, &fake_changes_get_param_data, &fake_changes_add_param_data},
+};
+
+//------------------------------------------------------------------------------
+static void *volatile bench_sink;
+
+template <class Fn>
+static double median_ns(uint32_t iterations, Fn &&fn)
+{
+    std::vector<double> times(iterations);
+    for (uint32_t i = 0; i < iterations; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        auto end = std::chrono::steady_clock::now();
+        times[i] = std::chrono::duration<double, std::nano>(end - start).count();
+    }
+    std::nth_element(times.begin(), times.begin() + iterations / 2, times.end());
+    return times[iterations / 2];
+}
+
+// the plugin outputs one value for each of the parameters, with a stride
+static void fill_param_events(ct_events_buffer &events, uint32_t param_count, uint32_t stride)
+{
+    events.clear();
+    for (uint32_t index = 0; index < param_count; index += stride) {
+        clap_event_param_value *ev = events.emplace<clap_event_param_value>();
+        if (!ev)
+            break;
+        ev->header.time = index % 512;
+        ev->header.type = CLAP_EVENT_PARAM_VALUE;
+        ev->param_id = dummy_plugin_param_id(index);
+        ev->note_id = -1;
+        ev->port_index = -1;
+        ev->channel = -1;
+        ev->key = -1;
+        ev->value = 0.5;
+        events.commit();
+    }
+}
+
+static bool bench_param_count(uint32_t param_count, uint32_t iterations)
+{
+    set_dummy_plugin_param_count(param_count);
+
+    v3_tuid clsiid = {};
+    bool init_ok = false;
+    std::unique_ptr<ct_component> comp{new ct_component{clsiid, &dummy_plugin_factory, &dummy_plugin_descriptor, nullptr, &init_ok}};
+    if (!init_ok) {
+        std::fprintf(stderr, "Cannot create the component\n");
+        return false;
+    }
+
+    event_converter_clap_to_v3 converter{comp.get()};
+    ct_events_buffer events{param_count * (uint32_t)sizeof(clap_event_param_value)};
+    fake_param_changes changes{param_count};
+    converter.set_input(&events);
+    converter.set_output((v3::param_changes *)&changes, nullptr);
+
+    auto transfer = [&converter, &changes]() {
+        changes.clear();
+        converter.transfer();
+    };
+
+    // the former reset of the queue table, on each block
+    std::vector<v3::param_value_queue *> table(param_count);
+    double reset_ns = median_ns(iterations, [&table]() {
+        std::fill(table.begin(), table.end(), nullptr);
+        bench_sink = table.data();
+    });
+
+    events.clear();
+    double idle_ns = median_ns(iterations, transfer);
+
+    fill_param_events(events, param_count, param_count / 16);
+    double sparse_ns = median_ns(iterations, transfer);
+
+    fill_param_events(events, param_count, 1);
+    double dense_ns = median_ns(std::max(iterations / 100, 10u), transfer);
+    double dense_per_event = dense_ns / std::max(events.count(), 1u);
+
+    std::printf("%8u %14.0f %10.0f %12.0f %12.0f %10.1f\n",
+                param_count, reset_ns, idle_ns, sparse_ns, dense_ns, dense_per_event);
+    return true;
+}
+
+static void usage()
+{
+    std::fprintf(stderr, "Usage: ct-bench-events [-n iterations]\n");
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t iterations = 10000;
+
+    for (int c; (c = getopt(argc, argv, "n:h")) != -1; ) {
+        switch (c) {
+        case 'n':
+            iterations = (uint32_t)std::atol(optarg);
+            if (iterations == 0) {
+                usage();
+                return 1;
+            }
+            break;
+        default:
+            usage();
+            return 1;
+        }
+    }
+
+    // median time of a block, in nanoseconds
+    std::printf("%8s %14s %10s %12s %12s %10s\n",
+                "PARAMS", "TABLE RESET", "IDLE", "SPARSE(16)", "DENSE", "NS/EVENT");
+
+    for (uint32_t param_count : {1000u, 10000u, 100000u}) {
+        if (!bench_param_count(param_count, iterations))
+            return 1;
+    }
+
+    return 0;
+}
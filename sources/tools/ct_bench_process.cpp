@@ -0,0 +1,173 @@
+// ct-bench-process: times the preparation and the release of the buffers of
+// a block, by the specialized process path of the 2:2 layout and by the
+// generic path, with the dummy plugin
+//
+// usage: ct-bench-process [-n iterations]
+
+#include "ct_dummy_plugin.hpp"
+#include "v3/ct_component.hpp"
+#include "v3/ct_audio_processor.hpp"
+#include "v3/ct_shared_buffers.hpp"
+#include "v3/ct_threads.hpp"
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <type_traits>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace ct;
+
+template <class Real>
+struct stereo_buffers {
+    std::vector<Real> m_data;
+    Real *m_channels[2] = {};
+
+    explicit stereo_buffers(uint32_t nframes) : m_data(2 * nframes)
+    {
+        m_channels[0] = &m_data[0];
+        m_channels[1] = &m_data[nframes];
+    }
+};
+
+// the median time of a block, over batches which amortize the clock
+template <class Real>
+static double median_block_ns(ct_component *comp, const ct_process_kernel *kernel, uint32_t block_size, uint32_t iterations)
+{
+    constexpr uint32_t batch_size = 100;
+
+    stereo_buffers<Real> input{block_size};
+    stereo_buffers<Real> output{block_size};
+    for (uint32_t i = 0; i < 2 * block_size; ++i)
+        input.m_data[i] = output.m_data[i] = Real(i % 64) / 64;
+
+    v3_audio_bus_buffers input_bus{};
+    v3_audio_bus_buffers output_bus{};
+    input_bus.num_channels = 2;
+    output_bus.num_channels = 2;
+    if (std::is_same<Real, double>::value) {
+        input_bus.channel_buffers_64 = (double **)input.m_channels;
+        output_bus.channel_buffers_64 = (double **)output.m_channels;
+    }
+    else {
+        input_bus.channel_buffers_32 = (float **)input.m_channels;
+        output_bus.channel_buffers_32 = (float **)output.m_channels;
+    }
+
+    v3_process_data data{};
+    data.process_mode = V3_REALTIME;
+    data.symbolic_sample_size = std::is_same<Real, double>::value ? V3_SAMPLE_64 : V3_SAMPLE_32;
+    data.nframes = (int32_t)block_size;
+    data.num_input_buses = 1;
+    data.num_output_buses = 1;
+    data.inputs = &input_bus;
+    data.outputs = &output_bus;
+
+    // as the audio thread, which leases the scratch memory
+    ct_thread_role_scope role{ct_thread_role_audio};
+    ct_scratch_lease scratch;
+    if (!scratch)
+        return 0;
+    comp->m_plan.bind_scratch(scratch.data());
+
+    clap_process clap_data{};
+    clap_data.frames_count = block_size;
+
+    uint32_t num_batches = std::max(iterations / batch_size, 1u);
+    std::vector<double> times(num_batches);
+    for (uint32_t b = 0; b < num_batches; ++b) {
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < batch_size; ++i) {
+            if (!kernel->prepare(comp, &data, 0, block_size, &clap_data))
+                return 0;
+            kernel->release(comp, &data, 0, block_size, &clap_data);
+        }
+        auto end = std::chrono::steady_clock::now();
+        times[b] = std::chrono::duration<double, std::nano>(end - start).count() / batch_size;
+    }
+    std::nth_element(times.begin(), times.begin() + num_batches / 2, times.end());
+    return times[num_batches / 2];
+}
+
+static bool bench_setup(ct_component *comp, bool double_precision, uint32_t block_size, uint32_t iterations)
+{
+    ct_audio_processor *proc = comp->m_audio_processor.get();
+
+    int32_t sample_size = double_precision ? V3_SAMPLE_64 : V3_SAMPLE_32;
+    v3_process_setup setup{V3_REALTIME, sample_size, (int32_t)block_size, 48000.0};
+    if (ct_audio_processor::setup_processing(proc, &setup) != V3_OK ||
+        ct_component::set_active(comp, true) != V3_OK) {
+        std::fprintf(stderr, "Cannot activate the component\n");
+        return false;
+    }
+
+    const ct_process_kernel *fixed_kernel = comp->m_fixed_kernel;
+    const ct_process_kernel *generic_kernel = ct_audio_processor::select_generic_kernel(comp, double_precision);
+    if (!fixed_kernel) {
+        std::fprintf(stderr, "The component has no specialized path\n");
+        return false;
+    }
+
+    auto median_ns = double_precision ? &median_block_ns<double> : &median_block_ns<float>;
+    double fixed_ns = median_ns(comp, fixed_kernel, block_size, iterations);
+    double generic_ns = median_ns(comp, generic_kernel, block_size, iterations);
+
+    ct_component::set_active(comp, false);
+
+    if (fixed_ns == 0 || generic_ns == 0) {
+        std::fprintf(stderr, "Cannot prepare the buffers\n");
+        return false;
+    }
+
+    std::printf("%6s %6u %10.1f %10.1f %8.2f\n",
+                double_precision ? "64" : "32", block_size,
+                fixed_ns, generic_ns, generic_ns / fixed_ns);
+    return true;
+}
+
+static void usage()
+{
+    std::fprintf(stderr, "Usage: ct-bench-process [-n iterations]\n");
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t iterations = 100000;
+
+    for (int c; (c = getopt(argc, argv, "n:h")) != -1; ) {
+        switch (c) {
+        case 'n':
+            iterations = (uint32_t)std::atol(optarg);
+            if (iterations == 0) {
+                usage();
+                return 1;
+            }
+            break;
+        default:
+            usage();
+            return 1;
+        }
+    }
+
+    v3_tuid clsiid = {};
+    bool init_ok = false;
+    std::unique_ptr<ct_component> comp{new ct_component{clsiid, &dummy_plugin_factory, &dummy_plugin_descriptor, nullptr, &init_ok}};
+    if (!init_ok) {
+        std::fprintf(stderr, "Cannot create the component\n");
+        return 1;
+    }
+
+    // median time of the preparation and the release, in nanoseconds
+    std::printf("%6s %6s %10s %10s %8s\n", "BITS", "FRAMES", "FIXED", "GENERIC", "RATIO");
+
+    for (bool double_precision : {false, true}) {
+        for (uint32_t block_size : {32u, 128u, 512u}) {
+            if (!bench_setup(comp.get(), double_precision, block_size, iterations))
+                return 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,184 @@
+#include "ct_dummy_plugin.hpp"
+#include <cstdio>
+#include <cstring>
+
+namespace ct {
+
+static uint32_t dummy_param_count = 0;
+
+void set_dummy_plugin_param_count(uint32_t count)
+{
+    dummy_param_count = count;
+}
+
+static const char *const dummy_features[] = {CLAP_PLUGIN_FEATURE_AUDIO_EFFECT, nullptr};
+
+const clap_plugin_descriptor dummy_plugin_descriptor = {
+    CLAP_VERSION, "net.sf.claptrap.dummy", "Dummy", "claptrap",
+    "", "", "", "0.0.0", "", dummy_features,
+};
+
+//------------------------------------------------------------------------------
+static uint32_t dummy_ports_count(const clap_plugin *, bool)
+{
+    return 1;
+}
+
+static bool dummy_ports_get(const clap_plugin *, uint32_t index, bool is_input, clap_audio_port_info *info)
+{
+    if (index != 0)
+        return false;
+
+    info->id = 0;
+    std::snprintf(info->name, sizeof(info->name), "%s", is_input ? "Input" : "Output");
+    info->flags = CLAP_AUDIO_PORT_IS_MAIN|CLAP_AUDIO_PORT_SUPPORTS_64BITS|CLAP_AUDIO_PORT_REQUIRES_COMMON_SAMPLE_SIZE;
+    info->channel_count = 2;
+    info->port_type = CLAP_PORT_STEREO;
+    info->in_place_pair = CLAP_INVALID_ID;
+    return true;
+}
+
+static const clap_plugin_audio_ports dummy_audio_ports = {
+    &dummy_ports_count,
+    &dummy_ports_get,
+};
+
+//------------------------------------------------------------------------------
+// the count is fixed at creation, in the data of the plugin
+static uint32_t dummy_params_count(const clap_plugin *plugin)
+{
+    return (uint32_t)(uintptr_t)plugin->plugin_data;
+}
+
+static bool dummy_params_get_info(const clap_plugin *plugin, uint32_t index, clap_param_info *info)
+{
+    if (index >= dummy_params_count(plugin))
+        return false;
+
+    *info = clap_param_info{};
+    info->id = dummy_plugin_param_id(index);
+    info->flags = CLAP_PARAM_IS_AUTOMATABLE;
+    std::snprintf(info->name, sizeof(info->name), "Parameter %u", index + 1);
+    info->min_value = 0.0;
+    info->max_value = 1.0;
+    info->default_value = 0.0;
+    return true;
+}
+
+static bool dummy_params_get_value(const clap_plugin *, clap_id, double *value)
+{
+    *value = 0.0;
+    return true;
+}
+
+static bool dummy_params_value_to_text(const clap_plugin *, clap_id, double value, char *display, uint32_t size)
+{
+    std::snprintf(display, size, "%g", value);
+    return true;
+}
+
+static bool dummy_params_text_to_value(const clap_plugin *, clap_id, const char *display, double *value)
+{
+    return std::sscanf(display, "%lf", value) == 1;
+}
+
+static void dummy_params_flush(const clap_plugin *, const clap_input_events *, const clap_output_events *)
+{
+}
+
+static const clap_plugin_params dummy_params = {
+    &dummy_params_count,
+    &dummy_params_get_info,
+    &dummy_params_get_value,
+    &dummy_params_value_to_text,
+    &dummy_params_text_to_value,
+    &dummy_params_flush,
+};
+
+//------------------------------------------------------------------------------
+template <class Real>
+static void dummy_gain(Real *const *inputs, Real *const *outputs, uint32_t nframes)
+{
+    for (uint32_t c = 0; c < 2; ++c) {
+        for (uint32_t i = 0; i < nframes; ++i)
+            outputs[c][i] = inputs[c][i] * Real(0.5);
+    }
+}
+
+static clap_process_status dummy_process(const clap_plugin *, const clap_process *process)
+{
+    const clap_audio_buffer &input = process->audio_inputs[0];
+    const clap_audio_buffer &output = process->audio_outputs[0];
+
+    if (output.data64)
+        dummy_gain(input.data64, output.data64, process->frames_count);
+    else
+        dummy_gain(input.data32, output.data32, process->frames_count);
+
+    return CLAP_PROCESS_CONTINUE;
+}
+
+static bool dummy_init(const clap_plugin *) { return true; }
+static void dummy_destroy(const clap_plugin *plugin) { delete plugin; }
+static bool dummy_activate(const clap_plugin *, double, uint32_t, uint32_t) { return true; }
+static void dummy_deactivate(const clap_plugin *) {}
+static bool dummy_start_processing(const clap_plugin *) { return true; }
+static void dummy_stop_processing(const clap_plugin *) {}
+static void dummy_reset(const clap_plugin *) {}
+static void dummy_on_main_thread(const clap_plugin *) {}
+
+static const void *dummy_get_extension(const clap_plugin *, const char *id)
+{
+    if (!std::strcmp(id, CLAP_EXT_AUDIO_PORTS))
+        return &dummy_audio_ports;
+    if (!std::strcmp(id, CLAP_EXT_PARAMS))
+        return &dummy_params;
+    return nullptr;
+}
+
+//------------------------------------------------------------------------------
+static uint32_t dummy_factory_count(const clap_plugin_factory *)
+{
+    return 1;
+}
+
+static const clap_plugin_descriptor *dummy_factory_descriptor(const clap_plugin_factory *, uint32_t index)
+{
+    return (index == 0) ? &dummy_plugin_descriptor : nullptr;
+}
+
+static const clap_plugin *dummy_factory_create(const clap_plugin_factory *, const clap_host *, const char *plugin_id)
+{
+    if (std::strcmp(plugin_id, dummy_plugin_descriptor.id))
+        return nullptr;
+
+    return new clap_plugin{
+        &dummy_plugin_descriptor, (void *)(uintptr_t)dummy_param_count,
+        &dummy_init, &dummy_destroy, &dummy_activate, &dummy_deactivate,
+        &dummy_start_processing, &dummy_stop_processing, &dummy_reset,
+        &dummy_process, &dummy_get_extension, &dummy_on_main_thread,
+    };
+}
+
+const clap_plugin_factory dummy_plugin_factory = {
+    &dummy_factory_count,
+    &dummy_factory_descriptor,
+    &dummy_factory_create,
+};
+
+static bool dummy_entry_init(const char *) { return true; }
+static void dummy_entry_deinit() {}
+
+static const void *dummy_entry_get_factory(const char *factory_id)
+{
+    return std::strcmp(factory_id, CLAP_PLUGIN_FACTORY_ID) ? nullptr : &dummy_plugin_factory;
+}
+
+} // namespace ct
+
+extern "C" const clap_plugin_entry clap_entry = {
+    CLAP_VERSION,
+    &ct::dummy_entry_init,
+    &ct::dummy_entry_deinit,
+    &ct::dummy_entry_get_factory,
+};
@@ -0,0 +1,19 @@
+#pragma once
+#include <clap/clap.h>
+#include <cstdint>
+
+namespace ct {
+
+// A plugin for the tools which drive the wrapper, which links it in place of
+// a real plugin, as `clap_entry`: a stereo gain in both sample sizes, with a
+// number of automatable parameters which do nothing
+extern const clap_plugin_descriptor dummy_plugin_descriptor;
+extern const clap_plugin_factory dummy_plugin_factory;
+
+// [main-thread] set the number of parameters of the plugins created next
+void set_dummy_plugin_param_count(uint32_t count);
+
+// the identifier of a parameter, which is sparse like in real plugins
+inline clap_id dummy_plugin_param_id(uint32_t index) noexcept { return 1000 + 7 * index; }
+
+} // namespace ct
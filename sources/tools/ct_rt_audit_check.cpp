@@ -0,0 +1,172 @@
+// ct-rt-audit-check: drives the processing of the wrapper on the dummy plugin,
+// and fails if the real-time audit counts violations of the wrapper, see
+// `rt_audit`; it requires the build with `CT_RT_AUDIT`
+//
+// usage: ct-rt-audit-check [-n blocks] [-b block-size] [-d]
+
+#include "utility/ct_rt_audit.hpp"
+#include <travesty/base.h>
+#include <travesty/factory.h>
+#include <travesty/component.h>
+#include <travesty/audio_processor.h>
+#include <unistd.h>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace ct;
+
+extern "C" void *V3_API GetPluginFactory();
+
+//------------------------------------------------------------------------------
+template <class Real>
+struct stereo_buffers {
+    std::vector<Real> m_data;
+    Real *m_channels[2] = {};
+
+    explicit stereo_buffers(uint32_t nframes) : m_data(2 * nframes)
+    {
+        m_channels[0] = &m_data[0];
+        m_channels[1] = &m_data[nframes];
+    }
+};
+
+template <class Real>
+static bool run_blocks(v3_audio_processor_cpp **proc, int32_t sample_size, uint32_t block_size, uint32_t num_blocks)
+{
+    stereo_buffers<Real> input{block_size};
+    stereo_buffers<Real> output{block_size};
+    for (uint32_t i = 0; i < block_size; ++i)
+        input.m_data[i] = input.m_data[block_size + i] = Real(i % 64) / 64;
+
+    v3_audio_bus_buffers input_bus{};
+    v3_audio_bus_buffers output_bus{};
+    input_bus.num_channels = 2;
+    output_bus.num_channels = 2;
+    if (sample_size == V3_SAMPLE_64) {
+        input_bus.channel_buffers_64 = (double **)input.m_channels;
+        output_bus.channel_buffers_64 = (double **)output.m_channels;
+    }
+    else {
+        input_bus.channel_buffers_32 = (float **)input.m_channels;
+        output_bus.channel_buffers_32 = (float **)output.m_channels;
+    }
+
+    v3_process_data data{};
+    data.process_mode = V3_REALTIME;
+    data.symbolic_sample_size = sample_size;
+    data.num_input_buses = 1;
+    data.num_output_buses = 1;
+    data.inputs = &input_bus;
+    data.outputs = &output_bus;
+
+    // the sizes vary, like the blocks of some hosts
+    for (uint32_t n = 0; n < num_blocks; ++n) {
+        data.nframes = (int32_t)((n % 3 == 2) ? (block_size / 3) : block_size);
+        if ((*proc)->proc.process(proc, &data) != V3_OK)
+            return false;
+    }
+
+    return true;
+}
+
+static bool run_session(v3_component_cpp **comp, v3_audio_processor_cpp **proc, int32_t sample_size, uint32_t block_size, uint32_t num_blocks)
+{
+    v3_process_setup setup{V3_REALTIME, sample_size, (int32_t)block_size, 48000.0};
+    if ((*proc)->proc.setup_processing(proc, &setup) != V3_OK) {
+        std::fprintf(stderr, "Cannot set up the processing\n");
+        return false;
+    }
+
+    if ((*comp)->comp.set_active(comp, true) != V3_OK) {
+        std::fprintf(stderr, "Cannot activate the component\n");
+        return false;
+    }
+
+    (*proc)->proc.set_processing(proc, true);
+    bool ok = (sample_size == V3_SAMPLE_64) ?
+        run_blocks<double>(proc, sample_size, block_size, num_blocks) :
+        run_blocks<float>(proc, sample_size, block_size, num_blocks);
+    (*proc)->proc.set_processing(proc, false);
+
+    (*comp)->comp.set_active(comp, false);
+
+    if (!ok)
+        std::fprintf(stderr, "Cannot process the blocks\n");
+    return ok;
+}
+
+static void usage()
+{
+    std::fprintf(stderr, "Usage: ct-rt-audit-check [-n blocks] [-b block-size] [-d]\n");
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t num_blocks = 1000;
+    uint32_t block_size = 512;
+    bool double_precision = false;
+
+    for (int c; (c = getopt(argc, argv, "n:b:dh")) != -1; ) {
+        switch (c) {
+        case 'n':
+            num_blocks = (uint32_t)std::atol(optarg);
+            break;
+        case 'b':
+            block_size = (uint32_t)std::atol(optarg);
+            if (block_size < 3) {
+                usage();
+                return 1;
+            }
+            break;
+        case 'd':
+            double_precision = true;
+            break;
+        default:
+            usage();
+            return 1;
+        }
+    }
+
+    v3_plugin_factory_cpp **factory = (v3_plugin_factory_cpp **)GetPluginFactory();
+    v3_class_info info{};
+    if (!factory || (*factory)->v1.get_class_info(factory, 0, &info) != V3_OK) {
+        std::fprintf(stderr, "Cannot get the plugin class\n");
+        return 1;
+    }
+
+    v3_component_cpp **comp = nullptr;
+    if ((*factory)->v1.create_instance(factory, info.class_id, v3_component_iid, (void **)&comp) != V3_OK) {
+        std::fprintf(stderr, "Cannot create the component\n");
+        return 1;
+    }
+
+    v3_audio_processor_cpp **proc = nullptr;
+    if ((*comp)->base.initialize(comp, nullptr) != V3_OK ||
+        (*comp)->query_interface(comp, v3_audio_processor_iid, (void **)&proc) != V3_OK) {
+        std::fprintf(stderr, "Cannot initialize the component\n");
+        return 1;
+    }
+
+    // twice, to cover a restart of the processing
+    int32_t sample_size = double_precision ? V3_SAMPLE_64 : V3_SAMPLE_32;
+    bool ok = run_session(comp, proc, sample_size, block_size, num_blocks) &&
+        run_session(comp, proc, sample_size, block_size, num_blocks);
+
+    (*proc)->unref(proc);
+    (*comp)->base.terminate(comp);
+    (*comp)->unref(comp);
+
+    rt_audit::report();
+
+    if (!ok)
+        return 1;
+
+    uint64_t violations = rt_audit::violations(rt_audit::wrapper);
+    if (violations != 0) {
+        std::fprintf(stderr, "The wrapper has %llu real-time violations\n", (unsigned long long)violations);
+        return 1;
+    }
+
+    return 0;
+}
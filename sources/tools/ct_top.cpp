@@ -0,0 +1,199 @@
+// ct-top: displays the live statistics which the wrapped instances of the
+// user publish in shared memory, see `ct_live_stats`
+//
+// usage: ct-top [-d seconds] [-n iterations]
+
+#include "v3/ct_live_stats.hpp"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <chrono>
+#include <thread>
+#include <utility>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace ct;
+
+struct slot_sample {
+    bool m_live = false;
+    uint32_t m_pid = 0;
+    char m_name[ct_live_stats_name_size] = {};
+    uint32_t m_active = 0;
+    uint32_t m_sample_rate = 0;
+    uint64_t m_process_calls = 0;
+    uint64_t m_process_ns = 0;
+    uint64_t m_process_max_ns = 0;
+    uint64_t m_blocks = 0;
+    uint64_t m_sleeping_blocks = 0;
+    uint64_t m_events_in = 0;
+    uint64_t m_events_out = 0;
+    uint64_t m_events_dropped = 0;
+    uint64_t m_timer_callbacks = 0;
+    uint64_t m_memory_bytes = 0;
+};
+
+static const ct_live_stats_segment *open_segment()
+{
+    char name[ct_live_stats_segment_name_size];
+    ct_live_stats_segment_name(name, sizeof(name), (uint32_t)getuid());
+
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd == -1) {
+        std::fprintf(stderr, "Cannot open the live statistics: %s\n", std::strerror(errno));
+        return nullptr;
+    }
+
+    constexpr size_t size = sizeof(ct_live_stats_segment);
+    struct stat st;
+    void *addr = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && (size_t)st.st_size == size)
+        addr = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+
+    const ct_live_stats_segment *segment = (const ct_live_stats_segment *)addr;
+    if (addr == MAP_FAILED || segment->m_header.load(std::memory_order_acquire) != ct_live_stats_segment::header()) {
+        std::fprintf(stderr, "Cannot map the live statistics, the segment is of another version\n");
+        return nullptr;
+    }
+
+    return segment;
+}
+
+static void take_sample(const ct_live_stats_slot &slot, slot_sample &sample)
+{
+    sample.m_live = slot.m_state.load(std::memory_order_acquire) == ct_live_stats_slot::live;
+    if (!sample.m_live)
+        return;
+
+    sample.m_pid = slot.m_pid.load(std::memory_order_relaxed);
+    std::memcpy(sample.m_name, slot.m_name, ct_live_stats_name_size);
+    sample.m_name[ct_live_stats_name_size - 1] = '\0';
+    sample.m_active = slot.m_active.load(std::memory_order_relaxed);
+    sample.m_sample_rate = slot.m_sample_rate.load(std::memory_order_relaxed);
+    sample.m_process_calls = slot.m_process_calls.load(std::memory_order_relaxed);
+    sample.m_process_ns = slot.m_process_ns.load(std::memory_order_relaxed);
+    sample.m_process_max_ns = slot.m_process_max_ns.load(std::memory_order_relaxed);
+    sample.m_blocks = slot.m_blocks.load(std::memory_order_relaxed);
+    sample.m_sleeping_blocks = slot.m_sleeping_blocks.load(std::memory_order_relaxed);
+    sample.m_events_in = slot.m_events_in.load(std::memory_order_relaxed);
+    sample.m_events_out = slot.m_events_out.load(std::memory_order_relaxed);
+    sample.m_events_dropped = slot.m_events_dropped.load(std::memory_order_relaxed);
+    sample.m_timer_callbacks = slot.m_timer_callbacks.load(std::memory_order_relaxed);
+    sample.m_memory_bytes = slot.m_memory_bytes.load(std::memory_order_relaxed);
+}
+
+static bool process_is_dead(uint32_t pid)
+{
+    return kill((pid_t)pid, 0) == -1 && errno == ESRCH;
+}
+
+// the rates are over the interval, and the others since the instance started
+static void print_samples(const slot_sample *current, const slot_sample *previous, double interval)
+{
+    std::printf("%7s %-24s %5s %6s %8s %8s %8s %6s %6s %8s %8s %7s %6s %8s\n",
+                "PID", "NAME", "STATE", "RATE", "CALLS/s", "AVG us", "MAX us", "LOAD%",
+                "SLEEP%", "EVIN/s", "EVOUT/s", "DROPPED", "TMR/s", "MEM KiB");
+
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < ct_live_stats_max_slots; ++i) {
+        const slot_sample &cur = current[i];
+        if (!cur.m_live)
+            continue;
+        ++count;
+
+        // the deltas are only valid if the slot holds the same instance
+        slot_sample prev;
+        if (previous[i].m_live && previous[i].m_pid == cur.m_pid && previous[i].m_process_calls <= cur.m_process_calls)
+            prev = previous[i];
+
+        uint64_t calls = cur.m_process_calls - prev.m_process_calls;
+        uint64_t ns = cur.m_process_ns - prev.m_process_ns;
+        uint64_t blocks = cur.m_blocks - prev.m_blocks;
+        uint64_t sleeping = cur.m_sleeping_blocks - prev.m_sleeping_blocks;
+
+        const char *state = process_is_dead(cur.m_pid) ? "dead" : cur.m_active ? "on" : "off";
+        double avg_us = calls ? (ns * 1e-3 / calls) : 0.0;
+        double load = ns * 1e-9 / interval * 100;
+        double sleep_ratio = blocks ? (100.0 * sleeping / blocks) : 0.0;
+
+        std::printf("%7u %-24.24s %5s %6u %8.0f %8.1f %8.1f %6.1f %6.1f %8.0f %8.0f %7llu %6.1f %8llu\n",
+                    cur.m_pid, cur.m_name, state, cur.m_sample_rate,
+                    calls / interval, avg_us, cur.m_process_max_ns * 1e-3, load, sleep_ratio,
+                    (cur.m_events_in - prev.m_events_in) / interval,
+                    (cur.m_events_out - prev.m_events_out) / interval,
+                    (unsigned long long)cur.m_events_dropped,
+                    (cur.m_timer_callbacks - prev.m_timer_callbacks) / interval,
+                    (unsigned long long)(cur.m_memory_bytes / 1024));
+    }
+
+    if (count == 0)
+        std::printf("(no instances)\n");
+}
+
+static void usage()
+{
+    std::fprintf(stderr, "Usage: ct-top [-d seconds] [-n iterations]\n");
+}
+
+int main(int argc, char *argv[])
+{
+    double delay = 1.0;
+    long iterations = -1;
+
+    for (int c; (c = getopt(argc, argv, "d:n:h")) != -1; ) {
+        switch (c) {
+        case 'd':
+            delay = std::atof(optarg);
+            if (delay <= 0) {
+                usage();
+                return 1;
+            }
+            break;
+        case 'n':
+            iterations = std::atol(optarg);
+            break;
+        default:
+            usage();
+            return 1;
+        }
+    }
+
+    const ct_live_stats_segment *segment = open_segment();
+    if (!segment)
+        return 1;
+
+    static slot_sample samples[2][ct_live_stats_max_slots];
+    slot_sample *current = samples[0];
+    slot_sample *previous = samples[1];
+
+    auto time = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < ct_live_stats_max_slots; ++i)
+        take_sample(segment->m_slots[i], previous[i]);
+
+    bool interactive = isatty(STDOUT_FILENO);
+    for (long n = 0; iterations < 0 || n < iterations; ++n) {
+        std::this_thread::sleep_for(std::chrono::duration<double>(delay));
+
+        auto now = std::chrono::steady_clock::now();
+        double interval = std::chrono::duration<double>(now - time).count();
+        time = now;
+        for (uint32_t i = 0; i < ct_live_stats_max_slots; ++i)
+            take_sample(segment->m_slots[i], current[i]);
+
+        if (interactive)
+            std::fputs("\033[H\033[2J", stdout);
+        else if (n > 0)
+            std::fputc('\n', stdout);
+        print_samples(current, previous, interval);
+        std::fflush(stdout);
+
+        std::swap(current, previous);
+    }
+
+    return 0;
+}
@@ -0,0 +1,376 @@
+#include "ct_audio_kernels.hpp"
+#include <limits>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   define CT_KERNELS_SSE2 1
+#   include <emmintrin.h>
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#   define CT_KERNELS_AVX2 1
+#   define CT_TARGET_AVX2 __attribute__((target("avx2")))
+#   include <immintrin.h>
+#endif
+
+namespace ct {
+
+//------------------------------------------------------------------------------
+template <class Real>
+static bool all_equal_scalar(const Real *buf, uint32_t count, Real value) noexcept
+{
+    for (uint32_t i = 0; i < count; ++i) {
+        if (buf[i] != value)
+            return false;
+    }
+    return true;
+}
+
+template <class Src, class Dst>
+static void convert_scalar(const Src *src, Dst *dst, uint32_t count) noexcept
+{
+    for (uint32_t i = 0; i < count; ++i)
+        dst[i] = (Dst)src[i];
+}
+
+template <class Real>
+static uint32_t sanitize_scalar(Real *buf, uint32_t count) noexcept
+{
+    uint32_t found = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        Real x = buf[i];
+        if (!std::isfinite(x))
+            found |= sanitize_found_non_finite;
+        else if (x != 0 && std::fabs(x) < std::numeric_limits<Real>::min())
+            found |= sanitize_found_subnormal;
+        else
+            continue;
+        buf[i] = 0;
+    }
+    return found;
+}
+
+//------------------------------------------------------------------------------
+// NOTE: the sanitizers detect values in the floating point domain: x*0 is NaN
+// only if x is not finite, and subnormals compare below the smallest normal.
+// Vectors are only written back if they contain something to replace.
+
+//------------------------------------------------------------------------------
+// NOTE: the comparisons are unordered, so that NaN is different from anything.
+// The loops test several vectors at once, and stop on the first difference.
+
+#if CT_KERNELS_SSE2
+static bool all_equal_sse2(const float *buf, uint32_t count, float value) noexcept
+{
+    const __m128 ref = _mm_set1_ps(value);
+    uint32_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128 d0 = _mm_cmpneq_ps(_mm_loadu_ps(buf + i), ref);
+        __m128 d1 = _mm_cmpneq_ps(_mm_loadu_ps(buf + i + 4), ref);
+        __m128 d2 = _mm_cmpneq_ps(_mm_loadu_ps(buf + i + 8), ref);
+        __m128 d3 = _mm_cmpneq_ps(_mm_loadu_ps(buf + i + 12), ref);
+        if (_mm_movemask_ps(_mm_or_ps(_mm_or_ps(d0, d1), _mm_or_ps(d2, d3))))
+            return false;
+    }
+    for (; i + 4 <= count; i += 4) {
+        if (_mm_movemask_ps(_mm_cmpneq_ps(_mm_loadu_ps(buf + i), ref)))
+            return false;
+    }
+    return all_equal_scalar(buf + i, count - i, value);
+}
+
+static bool all_equal_sse2(const double *buf, uint32_t count, double value) noexcept
+{
+    const __m128d ref = _mm_set1_pd(value);
+    uint32_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128d d0 = _mm_cmpneq_pd(_mm_loadu_pd(buf + i), ref);
+        __m128d d1 = _mm_cmpneq_pd(_mm_loadu_pd(buf + i + 2), ref);
+        __m128d d2 = _mm_cmpneq_pd(_mm_loadu_pd(buf + i + 4), ref);
+        __m128d d3 = _mm_cmpneq_pd(_mm_loadu_pd(buf + i + 6), ref);
+        if (_mm_movemask_pd(_mm_or_pd(_mm_or_pd(d0, d1), _mm_or_pd(d2, d3))))
+            return false;
+    }
+    for (; i + 2 <= count; i += 2) {
+        if (_mm_movemask_pd(_mm_cmpneq_pd(_mm_loadu_pd(buf + i), ref)))
+            return false;
+    }
+    return all_equal_scalar(buf + i, count - i, value);
+}
+
+static void convert_sse2(const float *src, double *dst, uint32_t count) noexcept
+{
+    uint32_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 x = _mm_loadu_ps(src + i);
+        _mm_storeu_pd(dst + i, _mm_cvtps_pd(x));
+        _mm_storeu_pd(dst + i + 2, _mm_cvtps_pd(_mm_movehl_ps(x, x)));
+    }
+    convert_scalar(src + i, dst + i, count - i);
+}
+
+static void convert_sse2(const double *src, float *dst, uint32_t count) noexcept
+{
+    uint32_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 lo = _mm_cvtpd_ps(_mm_loadu_pd(src + i));
+        __m128 hi = _mm_cvtpd_ps(_mm_loadu_pd(src + i + 2));
+        _mm_storeu_ps(dst + i, _mm_movelh_ps(lo, hi));
+    }
+    convert_scalar(src + i, dst + i, count - i);
+}
+
+static uint32_t sanitize_sse2(float *buf, uint32_t count) noexcept
+{
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 min_normal = _mm_set1_ps(std::numeric_limits<float>::min());
+    const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    uint32_t found = 0;
+    uint32_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 x = _mm_loadu_ps(buf + i);
+        __m128 non_finite = _mm_cmpunord_ps(_mm_mul_ps(x, zero), zero);
+        __m128 subnormal = _mm_and_ps(_mm_cmplt_ps(_mm_and_ps(x, abs_mask), min_normal), _mm_cmpneq_ps(x, zero));
+        __m128 bad = _mm_or_ps(non_finite, subnormal);
+        if (!_mm_movemask_ps(bad))
+            continue;
+        if (_mm_movemask_ps(non_finite))
+            found |= sanitize_found_non_finite;
+        if (_mm_movemask_ps(subnormal))
+            found |= sanitize_found_subnormal;
+        _mm_storeu_ps(buf + i, _mm_andnot_ps(bad, x));
+    }
+    return found | sanitize_scalar(buf + i, count - i);
+}
+
+static uint32_t sanitize_sse2(double *buf, uint32_t count) noexcept
+{
+    const __m128d zero = _mm_setzero_pd();
+    const __m128d min_normal = _mm_set1_pd(std::numeric_limits<double>::min());
+    const __m128d abs_mask = _mm_castsi128_pd(_mm_set1_epi64x(0x7fffffffffffffffll));
+    uint32_t found = 0;
+    uint32_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        __m128d x = _mm_loadu_pd(buf + i);
+        __m128d non_finite = _mm_cmpunord_pd(_mm_mul_pd(x, zero), zero);
+        __m128d subnormal = _mm_and_pd(_mm_cmplt_pd(_mm_and_pd(x, abs_mask), min_normal), _mm_cmpneq_pd(x, zero));
+        __m128d bad = _mm_or_pd(non_finite, subnormal);
+        if (!_mm_movemask_pd(bad))
+            continue;
+        if (_mm_movemask_pd(non_finite))
+            found |= sanitize_found_non_finite;
+        if (_mm_movemask_pd(subnormal))
+            found |= sanitize_found_subnormal;
+        _mm_storeu_pd(buf + i, _mm_andnot_pd(bad, x));
+    }
+    return found | sanitize_scalar(buf + i, count - i);
+}
+#endif
+
+#if CT_KERNELS_AVX2
+CT_TARGET_AVX2 static bool all_equal_avx2(const float *buf, uint32_t count, float value) noexcept
+{
+    const __m256 ref = _mm256_set1_ps(value);
+    uint32_t i = 0;
+    for (; i + 32 <= count; i += 32) {
+        __m256 d0 = _mm256_cmp_ps(_mm256_loadu_ps(buf + i), ref, _CMP_NEQ_UQ);
+        __m256 d1 = _mm256_cmp_ps(_mm256_loadu_ps(buf + i + 8), ref, _CMP_NEQ_UQ);
+        __m256 d2 = _mm256_cmp_ps(_mm256_loadu_ps(buf + i + 16), ref, _CMP_NEQ_UQ);
+        __m256 d3 = _mm256_cmp_ps(_mm256_loadu_ps(buf + i + 24), ref, _CMP_NEQ_UQ);
+        if (_mm256_movemask_ps(_mm256_or_ps(_mm256_or_ps(d0, d1), _mm256_or_ps(d2, d3))))
+            return false;
+    }
+    for (; i + 8 <= count; i += 8) {
+        if (_mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(buf + i), ref, _CMP_NEQ_UQ)))
+            return false;
+    }
+    return all_equal_scalar(buf + i, count - i, value);
+}
+
+CT_TARGET_AVX2 static bool all_equal_avx2(const double *buf, uint32_t count, double value) noexcept
+{
+    const __m256d ref = _mm256_set1_pd(value);
+    uint32_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256d d0 = _mm256_cmp_pd(_mm256_loadu_pd(buf + i), ref, _CMP_NEQ_UQ);
+        __m256d d1 = _mm256_cmp_pd(_mm256_loadu_pd(buf + i + 4), ref, _CMP_NEQ_UQ);
+        __m256d d2 = _mm256_cmp_pd(_mm256_loadu_pd(buf + i + 8), ref, _CMP_NEQ_UQ);
+        __m256d d3 = _mm256_cmp_pd(_mm256_loadu_pd(buf + i + 12), ref, _CMP_NEQ_UQ);
+        if (_mm256_movemask_pd(_mm256_or_pd(_mm256_or_pd(d0, d1), _mm256_or_pd(d2, d3))))
+            return false;
+    }
+    for (; i + 4 <= count; i += 4) {
+        if (_mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(buf + i), ref, _CMP_NEQ_UQ)))
+            return false;
+    }
+    return all_equal_scalar(buf + i, count - i, value);
+}
+
+CT_TARGET_AVX2 static void convert_avx2(const float *src, double *dst, uint32_t count) noexcept
+{
+    uint32_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_pd(dst + i, _mm256_cvtps_pd(_mm_loadu_ps(src + i)));
+        _mm256_storeu_pd(dst + i + 4, _mm256_cvtps_pd(_mm_loadu_ps(src + i + 4)));
+    }
+    convert_scalar(src + i, dst + i, count - i);
+}
+
+CT_TARGET_AVX2 static void convert_avx2(const double *src, float *dst, uint32_t count) noexcept
+{
+    uint32_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        _mm_storeu_ps(dst + i, _mm256_cvtpd_ps(_mm256_loadu_pd(src + i)));
+        _mm_storeu_ps(dst + i + 4, _mm256_cvtpd_ps(_mm256_loadu_pd(src + i + 4)));
+    }
+    convert_scalar(src + i, dst + i, count - i);
+}
+
+CT_TARGET_AVX2 static uint32_t sanitize_avx2(float *buf, uint32_t count) noexcept
+{
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 min_normal = _mm256_set1_ps(std::numeric_limits<float>::min());
+    const __m256 abs_mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+    uint32_t found = 0;
+    uint32_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 x = _mm256_loadu_ps(buf + i);
+        __m256 non_finite = _mm256_cmp_ps(_mm256_mul_ps(x, zero), zero, _CMP_UNORD_Q);
+        __m256 subnormal = _mm256_and_ps(
+            _mm256_cmp_ps(_mm256_and_ps(x, abs_mask), min_normal, _CMP_LT_OQ),
+            _mm256_cmp_ps(x, zero, _CMP_NEQ_UQ));
+        __m256 bad = _mm256_or_ps(non_finite, subnormal);
+        if (!_mm256_movemask_ps(bad))
+            continue;
+        if (_mm256_movemask_ps(non_finite))
+            found |= sanitize_found_non_finite;
+        if (_mm256_movemask_ps(subnormal))
+            found |= sanitize_found_subnormal;
+        _mm256_storeu_ps(buf + i, _mm256_andnot_ps(bad, x));
+    }
+    return found | sanitize_scalar(buf + i, count - i);
+}
+
+CT_TARGET_AVX2 static uint32_t sanitize_avx2(double *buf, uint32_t count) noexcept
+{
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d min_normal = _mm256_set1_pd(std::numeric_limits<double>::min());
+    const __m256d abs_mask = _mm256_castsi256_pd(_mm256_set1_epi64x(0x7fffffffffffffffll));
+    uint32_t found = 0;
+    uint32_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256d x = _mm256_loadu_pd(buf + i);
+        __m256d non_finite = _mm256_cmp_pd(_mm256_mul_pd(x, zero), zero, _CMP_UNORD_Q);
+        __m256d subnormal = _mm256_and_pd(
+            _mm256_cmp_pd(_mm256_and_pd(x, abs_mask), min_normal, _CMP_LT_OQ),
+            _mm256_cmp_pd(x, zero, _CMP_NEQ_UQ));
+        __m256d bad = _mm256_or_pd(non_finite, subnormal);
+        if (!_mm256_movemask_pd(bad))
+            continue;
+        if (_mm256_movemask_pd(non_finite))
+            found |= sanitize_found_non_finite;
+        if (_mm256_movemask_pd(subnormal))
+            found |= sanitize_found_subnormal;
+        _mm256_storeu_pd(buf + i, _mm256_andnot_pd(bad, x));
+    }
+    return found | sanitize_scalar(buf + i, count - i);
+}
+#endif
+
+//------------------------------------------------------------------------------
+struct audio_kernel_table {
+    bool (*all_equal_f32)(const float *, uint32_t, float) noexcept;
+    bool (*all_equal_f64)(const double *, uint32_t, double) noexcept;
+    void (*convert_f32_f64)(const float *, double *, uint32_t) noexcept;
+    void (*convert_f64_f32)(const double *, float *, uint32_t) noexcept;
+    uint32_t (*sanitize_f32)(float *, uint32_t) noexcept;
+    uint32_t (*sanitize_f64)(double *, uint32_t) noexcept;
+    const char *isa;
+};
+
+static audio_kernel_table select_audio_kernels() noexcept
+{
+    audio_kernel_table kt;
+    kt.all_equal_f32 = &all_equal_scalar<float>;
+    kt.all_equal_f64 = &all_equal_scalar<double>;
+    kt.convert_f32_f64 = &convert_scalar<float, double>;
+    kt.convert_f64_f32 = &convert_scalar<double, float>;
+    kt.sanitize_f32 = &sanitize_scalar<float>;
+    kt.sanitize_f64 = &sanitize_scalar<double>;
+    kt.isa = "scalar";
+
+#if CT_KERNELS_SSE2
+    kt.all_equal_f32 = &all_equal_sse2;
+    kt.all_equal_f64 = &all_equal_sse2;
+    kt.convert_f32_f64 = &convert_sse2;
+    kt.convert_f64_f32 = &convert_sse2;
+    kt.sanitize_f32 = &sanitize_sse2;
+    kt.sanitize_f64 = &sanitize_sse2;
+    kt.isa = "sse2";
+#endif
+
+#if CT_KERNELS_AVX2
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        kt.all_equal_f32 = &all_equal_avx2;
+        kt.all_equal_f64 = &all_equal_avx2;
+        kt.convert_f32_f64 = &convert_avx2;
+        kt.convert_f64_f32 = &convert_avx2;
+        kt.sanitize_f32 = &sanitize_avx2;
+        kt.sanitize_f64 = &sanitize_avx2;
+        kt.isa = "avx2";
+    }
+#endif
+
+    return kt;
+}
+
+static const audio_kernel_table s_audio_kernels = select_audio_kernels();
+
+//------------------------------------------------------------------------------
+bool buffer_is_silent(const float *buf, uint32_t count) noexcept
+{
+    return s_audio_kernels.all_equal_f32(buf, count, 0.0f);
+}
+
+bool buffer_is_silent(const double *buf, uint32_t count) noexcept
+{
+    return s_audio_kernels.all_equal_f64(buf, count, 0.0);
+}
+
+bool buffer_is_constant(const float *buf, uint32_t count) noexcept
+{
+    return count < 2 || s_audio_kernels.all_equal_f32(buf + 1, count - 1, buf[0]);
+}
+
+bool buffer_is_constant(const double *buf, uint32_t count) noexcept
+{
+    return count < 2 || s_audio_kernels.all_equal_f64(buf + 1, count - 1, buf[0]);
+}
+
+void convert_buffer(const float *src, double *dst, uint32_t count) noexcept
+{
+    s_audio_kernels.convert_f32_f64(src, dst, count);
+}
+
+void convert_buffer(const double *src, float *dst, uint32_t count) noexcept
+{
+    s_audio_kernels.convert_f64_f32(src, dst, count);
+}
+
+uint32_t sanitize_buffer(float *buf, uint32_t count) noexcept
+{
+    return s_audio_kernels.sanitize_f32(buf, count);
+}
+
+uint32_t sanitize_buffer(double *buf, uint32_t count) noexcept
+{
+    return s_audio_kernels.sanitize_f64(buf, count);
+}
+
+const char *audio_kernels_isa() noexcept
+{
+    return s_audio_kernels.isa;
+}
+
+} // namespace ct
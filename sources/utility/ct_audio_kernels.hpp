@@ -0,0 +1,33 @@
+#pragma once
+#include <cstdint>
+
+namespace ct {
+
+// Vectorized routines operating on blocks of samples.
+// The best implementation for the processor is selected when the module loads.
+
+// check if all samples of the buffer are zero
+bool buffer_is_silent(const float *buf, uint32_t count) noexcept;
+bool buffer_is_silent(const double *buf, uint32_t count) noexcept;
+
+// check if all samples of the buffer are identical
+bool buffer_is_constant(const float *buf, uint32_t count) noexcept;
+bool buffer_is_constant(const double *buf, uint32_t count) noexcept;
+
+// convert samples between single and double precision
+void convert_buffer(const float *src, double *dst, uint32_t count) noexcept;
+void convert_buffer(const double *src, float *dst, uint32_t count) noexcept;
+
+// replace the values which are not finite (infinity and NaN), and the
+// subnormal values, with zero; returns the kinds of values which were found
+enum : uint32_t {
+    sanitize_found_subnormal = 1 << 0,
+    sanitize_found_non_finite = 1 << 1,
+};
+uint32_t sanitize_buffer(float *buf, uint32_t count) noexcept;
+uint32_t sanitize_buffer(double *buf, uint32_t count) noexcept;
+
+// get the name of the instruction set in use
+const char *audio_kernels_isa() noexcept;
+
+} // namespace ct
@@ -0,0 +1,46 @@
+#pragma once
+#include <cstdint>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#   define CT_FP_STATE_MXCSR 1
+#   include <xmmintrin.h>
+#elif defined(__aarch64__)
+#   define CT_FP_STATE_FPCR 1
+#endif
+
+namespace ct {
+
+// Flushes denormal numbers to zero in the scope, both in results (FTZ) and
+// operands (DAZ), and restores the floating point state when leaving.
+// On ARM, FZ covers both, and other processors are left unchanged.
+class scoped_flush_denormals {
+public:
+    scoped_flush_denormals() noexcept
+    {
+#if CT_FP_STATE_MXCSR
+        m_state = _mm_getcsr();
+        _mm_setcsr((uint32_t)m_state | 0x8040u); // FTZ | DAZ
+#elif CT_FP_STATE_FPCR
+        uint64_t fpcr;
+        __asm__ __volatile__("mrs %0, fpcr" : "=r"(fpcr));
+        m_state = fpcr;
+        __asm__ __volatile__("msr fpcr, %0" : : "r"(fpcr | (uint64_t{1} << 24))); // FZ
+#endif
+    }
+
+    ~scoped_flush_denormals() noexcept
+    {
+#if CT_FP_STATE_MXCSR
+        _mm_setcsr((uint32_t)m_state);
+#elif CT_FP_STATE_FPCR
+        __asm__ __volatile__("msr fpcr, %0" : : "r"(m_state));
+#endif
+    }
+
+private:
+    uint64_t m_state = 0;
+    scoped_flush_denormals(const scoped_flush_denormals &) = delete;
+    scoped_flush_denormals &operator=(const scoped_flush_denormals &) = delete;
+};
+
+} // namespace ct
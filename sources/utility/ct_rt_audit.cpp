@@ -0,0 +1,237 @@
+#include "ct_rt_audit.hpp"
+
+#if CT_RT_AUDIT
+#include "ct_messages.hpp"
+#include <execinfo.h>
+#include <dlfcn.h>
+#include <pthread.h>
+#include <poll.h>
+#include <unistd.h>
+#include <time.h>
+#include <atomic>
+#include <cerrno>
+#include <new>
+#include <cstdio>
+#include <cstdlib>
+#include <cstddef>
+
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+void *__libc_memalign(size_t align, size_t size);
+void __libc_free(void *ptr);
+}
+
+namespace ct {
+
+enum { max_backtraces = 16, max_frames = 32 };
+
+static std::atomic<uint64_t> audit_counts[rt_audit::num_origins][rt_audit::num_kinds];
+static std::atomic<uint32_t> audit_backtraces{0};
+
+static const char *const origin_names[rt_audit::num_origins] = {"wrapper", "plugin"};
+
+uint64_t rt_audit::violations(origin o, kind k) noexcept
+{
+    return audit_counts[o][k].load(std::memory_order_relaxed);
+}
+
+uint64_t rt_audit::violations(origin o) noexcept
+{
+    uint64_t count = 0;
+    for (uint32_t k = 0; k < num_kinds; ++k)
+        count += violations(o, (kind)k);
+    return count;
+}
+
+void rt_audit::report()
+{
+    rt_audit_pause pause;
+
+    CT_MESSAGE("Real-time violations on the audio thread");
+    for (uint32_t o = 0; o < num_origins; ++o) {
+        CT_MESSAGE_NP(CT_MESSAGE_PREFIX_SPACES, origin_names[o], ": ",
+                      violations((origin)o, allocation), " allocations, ",
+                      violations((origin)o, lock), " locks, ",
+                      violations((origin)o, syscall), " syscalls");
+    }
+}
+
+// the audit is paused while reporting, so it does not recurse
+static void audit_violation(rt_audit::kind kind, const char *what) noexcept
+{
+    rt_audit_pause pause;
+
+    rt_audit::origin origin = (rt_audit_plugin_depth > 0) ? rt_audit::plugin : rt_audit::wrapper;
+    audit_counts[origin][kind].fetch_add(1, std::memory_order_relaxed);
+
+    if (audit_backtraces.fetch_add(1, std::memory_order_relaxed) < max_backtraces) {
+        char header[256];
+        int length = std::snprintf(header, sizeof(header), CT_MESSAGE_PREFIX "Real-time violation: %s by the %s\n", what, origin_names[origin]);
+        if (length > 0)
+            (void)!write(STDERR_FILENO, header, (size_t)length);
+        void *frames[max_frames];
+        int num_frames = backtrace(frames, max_frames);
+        backtrace_symbols_fd(frames, num_frames, STDERR_FILENO);
+    }
+}
+
+#define CT_AUDIT(kind, what) do {                               \
+        if (::ct::rt_audit_armed > 0)                           \
+            ::ct::audit_violation(::ct::rt_audit::kind, what);  \
+    } while (0)
+
+// the next definition of a function, which is in the C library
+template <class Fn> static Fn next_function(const char *name) noexcept
+{
+    rt_audit_pause pause;
+    return (Fn)dlsym(RTLD_NEXT, name);
+}
+
+#define CT_AUDIT_NEXT(name) \
+    static auto next = ::ct::next_function<decltype(&::name)>(#name)
+
+} // namespace ct
+
+//------------------------------------------------------------------------------
+extern "C" {
+
+void *malloc(size_t size)
+{
+    CT_AUDIT(allocation, "malloc");
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size)
+{
+    CT_AUDIT(allocation, "calloc");
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+    CT_AUDIT(allocation, "realloc");
+    return __libc_realloc(ptr, size);
+}
+
+void free(void *ptr)
+{
+    if (ptr)
+        CT_AUDIT(allocation, "free");
+    __libc_free(ptr);
+}
+
+int posix_memalign(void **ptr, size_t align, size_t size)
+{
+    CT_AUDIT(allocation, "posix_memalign");
+    if (align < sizeof(void *) || (align & (align - 1)) != 0)
+        return EINVAL;
+    void *p = __libc_memalign(align, size);
+    if (!p)
+        return ENOMEM;
+    *ptr = p;
+    return 0;
+}
+
+void *aligned_alloc(size_t align, size_t size)
+{
+    CT_AUDIT(allocation, "aligned_alloc");
+    return __libc_memalign(align, size);
+}
+
+int pthread_mutex_lock(pthread_mutex_t *mutex)
+{
+    CT_AUDIT(lock, "pthread_mutex_lock");
+    CT_AUDIT_NEXT(pthread_mutex_lock);
+    return next(mutex);
+}
+
+int pthread_cond_wait(pthread_cond_t *cond, pthread_mutex_t *mutex)
+{
+    CT_AUDIT(lock, "pthread_cond_wait");
+    CT_AUDIT_NEXT(pthread_cond_wait);
+    return next(cond, mutex);
+}
+
+int pthread_cond_timedwait(pthread_cond_t *cond, pthread_mutex_t *mutex, const struct timespec *abstime)
+{
+    CT_AUDIT(lock, "pthread_cond_timedwait");
+    CT_AUDIT_NEXT(pthread_cond_timedwait);
+    return next(cond, mutex, abstime);
+}
+
+ssize_t read(int fd, void *buf, size_t count)
+{
+    CT_AUDIT(syscall, "read");
+    CT_AUDIT_NEXT(read);
+    return next(fd, buf, count);
+}
+
+ssize_t write(int fd, const void *buf, size_t count)
+{
+    CT_AUDIT(syscall, "write");
+    CT_AUDIT_NEXT(write);
+    return next(fd, buf, count);
+}
+
+int poll(struct pollfd *fds, nfds_t nfds, int timeout)
+{
+    CT_AUDIT(syscall, "poll");
+    CT_AUDIT_NEXT(poll);
+    return next(fds, nfds, timeout);
+}
+
+int nanosleep(const struct timespec *req, struct timespec *rem)
+{
+    CT_AUDIT(syscall, "nanosleep");
+    CT_AUDIT_NEXT(nanosleep);
+    return next(req, rem);
+}
+
+int usleep(useconds_t usec)
+{
+    CT_AUDIT(syscall, "usleep");
+    CT_AUDIT_NEXT(usleep);
+    return next(usec);
+}
+
+} // extern "C"
+
+//------------------------------------------------------------------------------
+static void *audit_operator_new(size_t size, size_t align, bool nothrow)
+{
+    CT_AUDIT(allocation, "operator new");
+    void *ptr = (align > alignof(std::max_align_t)) ? __libc_memalign(align, size ? size : 1) : __libc_malloc(size ? size : 1);
+    if (!ptr && !nothrow)
+        throw std::bad_alloc{};
+    return ptr;
+}
+
+static void audit_operator_delete(void *ptr) noexcept
+{
+    if (ptr)
+        CT_AUDIT(allocation, "operator delete");
+    __libc_free(ptr);
+}
+
+void *operator new(size_t size) { return audit_operator_new(size, 0, false); }
+void *operator new[](size_t size) { return audit_operator_new(size, 0, false); }
+void *operator new(size_t size, const std::nothrow_t &) noexcept { return audit_operator_new(size, 0, true); }
+void *operator new[](size_t size, const std::nothrow_t &) noexcept { return audit_operator_new(size, 0, true); }
+void *operator new(size_t size, std::align_val_t align) { return audit_operator_new(size, (size_t)align, false); }
+void *operator new[](size_t size, std::align_val_t align) { return audit_operator_new(size, (size_t)align, false); }
+void *operator new(size_t size, std::align_val_t align, const std::nothrow_t &) noexcept { return audit_operator_new(size, (size_t)align, true); }
+void *operator new[](size_t size, std::align_val_t align, const std::nothrow_t &) noexcept { return audit_operator_new(size, (size_t)align, true); }
+
+void operator delete(void *ptr) noexcept { audit_operator_delete(ptr); }
+void operator delete[](void *ptr) noexcept { audit_operator_delete(ptr); }
+void operator delete(void *ptr, size_t) noexcept { audit_operator_delete(ptr); }
+void operator delete[](void *ptr, size_t) noexcept { audit_operator_delete(ptr); }
+void operator delete(void *ptr, std::align_val_t) noexcept { audit_operator_delete(ptr); }
+void operator delete[](void *ptr, std::align_val_t) noexcept { audit_operator_delete(ptr); }
+void operator delete(void *ptr, size_t, std::align_val_t) noexcept { audit_operator_delete(ptr); }
+void operator delete[](void *ptr, size_t, std::align_val_t) noexcept { audit_operator_delete(ptr); }
+void operator delete(void *ptr, const std::nothrow_t &) noexcept { audit_operator_delete(ptr); }
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept { audit_operator_delete(ptr); }
+#endif
@@ -0,0 +1,67 @@
+#pragma once
+#include <cstdint>
+
+namespace ct {
+
+// Audits the real-time safety of the audio thread, when built with
+// `CT_RT_AUDIT` (Linux only).
+// The allocator, the mutex lock, and the common blocking calls are
+// interposed, and they count as violations when they run in an armed scope,
+// which covers `process`. Each violation is attributed to the plugin if it
+// happens inside a call to the plugin, otherwise to the wrapper; the first
+// ones print a backtrace.
+// NOTE: the interposers only see the calls of the module itself, which is
+// linked with `-Bsymbolic` for that purpose.
+struct rt_audit {
+    enum origin : uint32_t { wrapper, plugin, num_origins };
+    enum kind : uint32_t { allocation, lock, syscall, num_kinds };
+
+    // [thread-safe] the violations counted since the start
+    static uint64_t violations(origin o, kind k) noexcept;
+    static uint64_t violations(origin o) noexcept;
+
+    // [main-thread] print the violations counted since the start
+    static void report();
+};
+
+inline thread_local uint32_t rt_audit_armed = 0;
+inline thread_local uint32_t rt_audit_plugin_depth = 0;
+
+// Arms the audit for the duration of the scope
+class rt_audit_scope {
+public:
+    rt_audit_scope() noexcept { ++rt_audit_armed; }
+    ~rt_audit_scope() noexcept { --rt_audit_armed; }
+
+private:
+    rt_audit_scope(const rt_audit_scope &) = delete;
+    rt_audit_scope &operator=(const rt_audit_scope &) = delete;
+};
+
+// Attributes the violations to the plugin for the duration of the scope
+class rt_audit_plugin_scope {
+public:
+    rt_audit_plugin_scope() noexcept { ++rt_audit_plugin_depth; }
+    ~rt_audit_plugin_scope() noexcept { --rt_audit_plugin_depth; }
+
+private:
+    rt_audit_plugin_scope(const rt_audit_plugin_scope &) = delete;
+    rt_audit_plugin_scope &operator=(const rt_audit_plugin_scope &) = delete;
+};
+
+// Disarms the audit for the duration of the scope, where the wrapper does
+// something unsafe on purpose
+class rt_audit_pause {
+public:
+    rt_audit_pause() noexcept : m_saved{rt_audit_armed} { rt_audit_armed = 0; }
+    ~rt_audit_pause() noexcept { rt_audit_armed = m_saved; }
+
+private:
+    rt_audit_pause(const rt_audit_pause &) = delete;
+    rt_audit_pause &operator=(const rt_audit_pause &) = delete;
+
+private:
+    uint32_t m_saved = 0;
+};
+
+} // namespace ct
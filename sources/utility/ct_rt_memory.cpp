@@ -0,0 +1,162 @@
+#include "ct_rt_memory.hpp"
+#include "ct_messages.hpp"
+#include <algorithm>
+#include <utility>
+#include <new>
+#include <cstdlib>
+#include <cstring>
+#if defined(_WIN32)
+#   include <malloc.h>
+#   include <windows.h>
+#else
+#   include <sys/mman.h>
+#   include <unistd.h>
+#endif
+
+namespace ct {
+
+static std::size_t page_size() noexcept
+{
+#if defined(_WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwPageSize;
+#else
+    long size = sysconf(_SC_PAGESIZE);
+    return (size > 0) ? (std::size_t)size : 4096;
+#endif
+}
+
+static bool protect_memory(void *data, std::size_t size, bool read_only) noexcept
+{
+#if defined(_WIN32)
+    DWORD old_protect;
+    return VirtualProtect(data, size, read_only ? PAGE_READONLY : PAGE_READWRITE, &old_protect) != 0;
+#else
+    return mprotect(data, size, read_only ? PROT_READ : (PROT_READ|PROT_WRITE)) == 0;
+#endif
+}
+
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+static constexpr std::size_t huge_page_size = 2 * 1024 * 1024;
+#endif
+
+rt_memory::~rt_memory() noexcept
+{
+    reset();
+}
+
+rt_memory::rt_memory(rt_memory &&other) noexcept
+    : m_data{other.m_data}, m_size{other.m_size}, m_locked{other.m_locked}, m_read_only{other.m_read_only}
+{
+    other.m_data = nullptr;
+    other.m_size = 0;
+    other.m_locked = false;
+    other.m_read_only = false;
+}
+
+rt_memory &rt_memory::operator=(rt_memory &&other) noexcept
+{
+    if (this != &other) {
+        reset();
+        std::swap(m_data, other.m_data);
+        std::swap(m_size, other.m_size);
+        std::swap(m_locked, other.m_locked);
+        std::swap(m_read_only, other.m_read_only);
+    }
+    return *this;
+}
+
+void rt_memory::allocate(std::size_t size, std::size_t align, uint32_t flags)
+{
+    reset();
+
+    size = std::max<std::size_t>(size, 1);
+    align = std::max(align, sizeof(void *));
+
+    // the protection applies to whole pages, which the block must not share
+    if (flags & read_only) {
+        std::size_t page = page_size();
+        align = std::max(align, page);
+        size = (size + (page - 1)) & ~(page - 1);
+    }
+
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    // a huge page is only usable if the block covers it entirely
+    bool use_huge_pages = (flags & huge_pages) && size >= huge_page_size;
+    if (use_huge_pages) {
+        align = std::max(align, huge_page_size);
+        size = (size + (huge_page_size - 1)) & ~(huge_page_size - 1);
+    }
+#endif
+
+    void *data;
+#if defined(_WIN32)
+    data = _aligned_malloc(size, align);
+#else
+    if (posix_memalign(&data, align, size) != 0)
+        data = nullptr;
+#endif
+    if (!data)
+        throw std::bad_alloc{};
+
+    m_data = (std::uint8_t *)data;
+    m_size = size;
+
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    // advise before the pages are touched, the kernel decides on first fault
+    if (use_huge_pages)
+        madvise(data, size, MADV_HUGEPAGE);
+#endif
+
+    // zeroing writes every page, so they are faulted in now, rather than
+    // during the first blocks on the audio thread
+    std::memset(data, 0, size);
+
+    if (flags & lock) {
+#if defined(_WIN32)
+        m_locked = VirtualLock(data, size) != 0;
+#else
+        m_locked = mlock(data, size) == 0;
+#endif
+        if (!m_locked)
+            CT_WARNING("Cannot lock ", size, " bytes of processing buffers in memory");
+    }
+
+    if (flags & read_only) {
+        m_read_only = protect_memory(data, size, true);
+        if (!m_read_only)
+            CT_WARNING("Cannot protect ", size, " bytes of processing buffers from writing");
+    }
+}
+
+void rt_memory::reset() noexcept
+{
+    if (!m_data)
+        return;
+
+    // the allocator writes into the blocks which it frees
+    if (m_read_only)
+        protect_memory(m_data, m_size, false);
+
+    if (m_locked) {
+#if defined(_WIN32)
+        VirtualUnlock(m_data, m_size);
+#else
+        munlock(m_data, m_size);
+#endif
+    }
+
+#if defined(_WIN32)
+    _aligned_free(m_data);
+#else
+    std::free(m_data);
+#endif
+
+    m_data = nullptr;
+    m_size = 0;
+    m_locked = false;
+    m_read_only = false;
+}
+
+} // namespace ct
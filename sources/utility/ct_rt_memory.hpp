@@ -0,0 +1,45 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace ct {
+
+// Memory for the audio thread, which is aligned, zeroed, and faulted in at
+// allocation, so that the first blocks do not take page faults.
+// Optionally, the pages are locked in physical memory, the large blocks
+// request transparent huge pages, and the block is made read-only once zeroed.
+class rt_memory {
+public:
+    enum : uint32_t {
+        lock = 1 << 0,
+        huge_pages = 1 << 1,
+        read_only = 1 << 2, // on whole pages, so the block is page-aligned
+    };
+
+    rt_memory() noexcept = default;
+    ~rt_memory() noexcept;
+    rt_memory(rt_memory &&other) noexcept;
+    rt_memory &operator=(rt_memory &&other) noexcept;
+
+    // NOTE: the alignment must be a power of two
+    void allocate(std::size_t size, std::size_t align, uint32_t flags = 0);
+    void reset() noexcept;
+
+    explicit operator bool() const noexcept { return m_data != nullptr; }
+    std::uint8_t *data() const noexcept { return m_data; }
+    std::size_t size() const noexcept { return m_size; }
+    bool locked() const noexcept { return m_locked; }
+    bool protected_read_only() const noexcept { return m_read_only; }
+
+private:
+    rt_memory(const rt_memory &other) = delete;
+    rt_memory &operator=(const rt_memory &other) = delete;
+
+private:
+    std::uint8_t *m_data = nullptr;
+    std::size_t m_size = 0;
+    bool m_locked = false;
+    bool m_read_only = false;
+};
+
+} // namespace ct
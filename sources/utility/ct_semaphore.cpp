@@ -0,0 +1,87 @@
+#include "ct_semaphore.hpp"
+#include <system_error>
+#include <cerrno>
+#if defined(_WIN32)
+#   include <windows.h>
+#elif defined(__APPLE__)
+#   include <dispatch/dispatch.h>
+#endif
+
+namespace ct {
+
+#if defined(_WIN32)
+rt_semaphore::rt_semaphore(uint32_t count)
+{
+    m_sem = CreateSemaphoreW(nullptr, (LONG)count, LONG_MAX, nullptr);
+    if (!m_sem)
+        throw std::system_error((int)GetLastError(), std::system_category());
+}
+
+rt_semaphore::~rt_semaphore() noexcept
+{
+    CloseHandle((HANDLE)m_sem);
+}
+
+void rt_semaphore::post(uint32_t count) noexcept
+{
+    if (count > 0)
+        ReleaseSemaphore((HANDLE)m_sem, (LONG)count, nullptr);
+}
+
+void rt_semaphore::wait() noexcept
+{
+    WaitForSingleObject((HANDLE)m_sem, INFINITE);
+}
+
+#elif defined(__APPLE__)
+rt_semaphore::rt_semaphore(uint32_t count)
+{
+    m_sem = dispatch_semaphore_create((long)count);
+    if (!m_sem)
+        throw std::system_error(ENOMEM, std::generic_category());
+}
+
+rt_semaphore::~rt_semaphore() noexcept
+{
+    dispatch_release((dispatch_semaphore_t)m_sem);
+}
+
+void rt_semaphore::post(uint32_t count) noexcept
+{
+    for (uint32_t i = 0; i < count; ++i)
+        dispatch_semaphore_signal((dispatch_semaphore_t)m_sem);
+}
+
+void rt_semaphore::wait() noexcept
+{
+    dispatch_semaphore_wait((dispatch_semaphore_t)m_sem, DISPATCH_TIME_FOREVER);
+}
+
+#else
+rt_semaphore::rt_semaphore(uint32_t count)
+{
+    if (sem_init(&m_sem, 0, count) != 0)
+        throw std::system_error(errno, std::generic_category());
+}
+
+rt_semaphore::~rt_semaphore() noexcept
+{
+    sem_destroy(&m_sem);
+}
+
+void rt_semaphore::post(uint32_t count) noexcept
+{
+    for (uint32_t i = 0; i < count; ++i)
+        sem_post(&m_sem);
+}
+
+void rt_semaphore::wait() noexcept
+{
+    int ret;
+    do {
+        ret = sem_wait(&m_sem);
+    } while (ret == -1 && errno == EINTR);
+}
+#endif
+
+} // namespace ct
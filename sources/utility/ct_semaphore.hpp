@@ -0,0 +1,30 @@
+#pragma once
+#include <cstdint>
+#if !defined(_WIN32) && !defined(__APPLE__)
+#include <semaphore.h>
+#endif
+
+namespace ct {
+
+// A counting semaphore, which the audio thread may post without blocking.
+class rt_semaphore {
+public:
+    explicit rt_semaphore(uint32_t count = 0);
+    ~rt_semaphore() noexcept;
+
+    void post(uint32_t count = 1) noexcept;
+    void wait() noexcept;
+
+private:
+    rt_semaphore(const rt_semaphore &other) = delete;
+    rt_semaphore &operator=(const rt_semaphore &other) = delete;
+
+private:
+#if !defined(_WIN32) && !defined(__APPLE__)
+    sem_t m_sem;
+#else
+    void *m_sem = nullptr;
+#endif
+};
+
+} // namespace ct
@@ -0,0 +1,189 @@
+#include "ct_trace.hpp"
+#include "ct_messages.hpp"
+#include <algorithm>
+#include <chrono>
+#include <new>
+#include <cstdio>
+#include <cstdlib>
+#if defined(_WIN32)
+#   include <process.h>
+#else
+#   include <unistd.h>
+#endif
+
+namespace ct {
+
+// the ring of the thread, claimed in the trace of the given session
+static thread_local trace_buffer *trace_thread_buffer = nullptr;
+static thread_local uint32_t trace_thread_session = 0;
+
+trace_recorder &trace_recorder::instance()
+{
+    static trace_recorder recorder;
+    return recorder;
+}
+
+uint64_t trace_recorder::now() noexcept
+{
+    auto time = std::chrono::steady_clock::now().time_since_epoch();
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(time).count();
+}
+
+void trace_recorder::attach()
+{
+    std::lock_guard<std::mutex> lock{m_mutex};
+
+    if (m_users++ > 0)
+        return;
+
+    const char *path = std::getenv("CT_TRACE");
+    if (!path || path[0] == '\0')
+        return;
+
+    if (!allocate_buffers())
+        return;
+
+    m_path = path;
+    m_start = now();
+    m_session.fetch_add(1, std::memory_order_relaxed);
+    trace_enabled.store(true, std::memory_order_release);
+}
+
+void trace_recorder::detach()
+{
+    std::lock_guard<std::mutex> lock{m_mutex};
+
+    if (--m_users > 0 || !trace_enabled.load(std::memory_order_relaxed))
+        return;
+
+    trace_enabled.store(false, std::memory_order_relaxed);
+    write_trace();
+    reset_buffers();
+}
+
+// the rings are allocated and faulted in on the main thread, the first time
+// that a trace starts, and they are kept for the next traces
+bool trace_recorder::allocate_buffers()
+{
+    if (m_memory)
+        return true;
+
+    try {
+        m_memory.allocate(max_threads * buffer_capacity * sizeof(trace_event), alignof(trace_event));
+    }
+    catch (std::bad_alloc &) {
+        CT_WARNING("Cannot allocate the trace buffers");
+        return false;
+    }
+
+    trace_event *events = (trace_event *)m_memory.data();
+    for (uint32_t i = 0; i < max_threads; ++i)
+        m_buffers[i].m_events = events + i * buffer_capacity;
+    return true;
+}
+
+// the threads which come after the last ring are not traced
+trace_buffer *trace_recorder::claim_buffer() noexcept
+{
+    uint32_t index = m_buffer_count.fetch_add(1, std::memory_order_relaxed);
+    return (index < max_threads) ? &m_buffers[index] : nullptr;
+}
+
+// the threads claim a ring again in the next trace
+void trace_recorder::reset_buffers() noexcept
+{
+    uint32_t num_buffers = std::min(m_buffer_count.load(std::memory_order_relaxed), (uint32_t)max_threads);
+    for (uint32_t i = 0; i < num_buffers; ++i)
+        m_buffers[i].m_count.store(0, std::memory_order_relaxed);
+    m_buffer_count.store(0, std::memory_order_relaxed);
+}
+
+void trace_recorder::record(const char *name, char phase) noexcept
+{
+    // an end event may come after the trace is written, and it's dropped
+    if (!trace_enabled.load(std::memory_order_acquire))
+        return;
+
+    uint32_t session = m_session.load(std::memory_order_relaxed);
+    trace_buffer *buffer = trace_thread_buffer;
+    if (trace_thread_session != session) {
+        buffer = trace_thread_buffer = claim_buffer();
+        trace_thread_session = session;
+    }
+    if (!buffer)
+        return;
+
+    uint64_t count = buffer->m_count.load(std::memory_order_relaxed);
+    trace_event &event = buffer->m_events[count & (buffer_capacity - 1)];
+    event.m_time = now();
+    event.m_name = name;
+    event.m_phase = phase;
+    buffer->m_count.store(count + 1, std::memory_order_release);
+}
+
+//------------------------------------------------------------------------------
+static void write_json_string(std::FILE *stream, const char *str)
+{
+    std::fputc('"', stream);
+    for (const char *p = str; *p; ++p) {
+        unsigned char c = (unsigned char)*p;
+        if (c == '"' || c == '\\')
+            std::fprintf(stream, "\\%c", c);
+        else if (c < 0x20)
+            std::fprintf(stream, "\\u%04x", c);
+        else
+            std::fputc(c, stream);
+    }
+    std::fputc('"', stream);
+}
+
+// the rings are written from the oldest event they keep
+void trace_recorder::write_trace()
+{
+    std::FILE *stream = std::fopen(m_path.c_str(), "w");
+    if (!stream) {
+        CT_WARNING("Cannot write the trace: ", m_path);
+        return;
+    }
+
+#if defined(_WIN32)
+    int pid = _getpid();
+#else
+    int pid = (int)getpid();
+#endif
+
+    uint64_t overwritten = 0;
+    uint32_t num_threads = m_buffer_count.load(std::memory_order_relaxed);
+    bool first = true;
+
+    std::fputs("{\"traceEvents\":[\n", stream);
+
+    uint32_t num_buffers = std::min(num_threads, (uint32_t)max_threads);
+    for (uint32_t tid = 0; tid < num_buffers; ++tid) {
+        const trace_buffer *buffer = &m_buffers[tid];
+        uint64_t count = buffer->m_count.load(std::memory_order_acquire);
+        uint64_t begin = (count > buffer_capacity) ? (count - buffer_capacity) : 0;
+        overwritten += begin;
+
+        for (uint64_t i = begin; i < count; ++i) {
+            const trace_event &event = buffer->m_events[i & (buffer_capacity - 1)];
+            std::fputs(first ? "" : ",\n", stream);
+            std::fputs("{\"name\":", stream);
+            write_json_string(stream, event.m_name);
+            std::fprintf(stream, ",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":%d,\"tid\":%u}",
+                         event.m_phase, (double)(event.m_time - m_start) * 1e-3, pid, tid);
+            first = false;
+        }
+    }
+
+    std::fputs("\n]}\n", stream);
+    std::fclose(stream);
+
+    CT_MESSAGE("Trace written: ", m_path);
+    if (overwritten > 0)
+        CT_MESSAGE_NP(CT_MESSAGE_PREFIX_SPACES, overwritten, " events were overwritten");
+    if (num_threads > max_threads)
+        CT_MESSAGE_NP(CT_MESSAGE_PREFIX_SPACES, num_threads - max_threads, " threads were not traced");
+}
+
+} // namespace ct
@@ -0,0 +1,94 @@
+#pragma once
+#include "ct_rt_memory.hpp"
+#include <string>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+
+namespace ct {
+
+// Records the calls of the wrapper and the plugin as a timeline, which is
+// written as Chrome trace events, for chrome://tracing or Perfetto.
+// It's enabled by the environment variable `CT_TRACE`, which names the output
+// file, and which is written when the last instance goes away.
+// Each thread writes begin and end events into a ring of its own, which keeps
+// the latest events. The rings are allocated when the trace starts, and a
+// thread claims one at its first event without locking; it keeps it until
+// the trace is written, then the rings are reset for the next trace.
+// When disabled, an event costs the load of a flag.
+struct trace_event {
+    uint64_t m_time; // nanoseconds of the steady clock
+    const char *m_name; // static string
+    char m_phase; // 'B' or 'E'
+};
+
+struct trace_buffer {
+    std::atomic<uint64_t> m_count{0};
+    trace_event *m_events = nullptr;
+};
+
+inline std::atomic<bool> trace_enabled{false};
+
+class trace_recorder {
+public:
+    static trace_recorder &instance();
+
+    // [main-thread] register an instance, starting the trace with the first
+    // if the environment requests it
+    void attach();
+    // [main-thread] unregister an instance, writing the trace with the last
+    void detach();
+
+    // [thread-safe] record an event of the current thread
+    void record(const char *name, char phase) noexcept;
+    static uint64_t now() noexcept;
+
+private:
+    trace_recorder() = default;
+    bool allocate_buffers();
+    trace_buffer *claim_buffer() noexcept;
+    void write_trace();
+    void reset_buffers() noexcept;
+
+private:
+    enum {
+        max_threads = 32,
+        buffer_capacity = 1 << 16,
+    };
+
+    std::mutex m_mutex;
+    uint32_t m_users = 0;
+    std::string m_path;
+    uint64_t m_start = 0;
+    rt_memory m_memory; // the events of all rings, kept for the next trace
+    trace_buffer m_buffers[max_threads];
+    std::atomic<uint32_t> m_buffer_count{0}; // rings claimed, or requested
+    std::atomic<uint32_t> m_session{0}; // increments with each trace
+};
+
+// Records the duration of the scope
+class trace_scope {
+public:
+    explicit trace_scope(const char *name) noexcept
+    {
+        if (trace_enabled.load(std::memory_order_relaxed)) {
+            m_name = name;
+            trace_recorder::instance().record(name, 'B');
+        }
+    }
+
+    ~trace_scope() noexcept
+    {
+        if (m_name)
+            trace_recorder::instance().record(m_name, 'E');
+    }
+
+private:
+    trace_scope(const trace_scope &) = delete;
+    trace_scope &operator=(const trace_scope &) = delete;
+
+private:
+    const char *m_name = nullptr;
+};
+
+} // namespace ct
@@ -30,6 +30,19 @@ std::string_view get_clap_default_window_api();
 struct ct_clap_port_info : public clap_audio_port_info_t {
     ct_clap_port_info() : clap_audio_port_info_t{} {}
     ct_channel_remapper mapping;
+    // index of the `in_place_pair` port in the opposite direction
+    enum : uint32_t { no_port = ~(uint32_t)0 };
+    uint32_t in_place_pair_index = no_port;
+};
+
+// audio ports activation extension
+// (defined here, since the CLAP headers may not have it, or have an older draft)
+static constexpr char ct_clap_ext_audio_ports_activation[] = "clap.audio-ports-activation/2";
+static constexpr char ct_clap_ext_audio_ports_activation_compat[] = "clap.audio-ports-activation.draft/2";
+
+struct ct_clap_plugin_audio_ports_activation {
+    bool (CLAP_ABI *can_activate_while_processing)(const clap_plugin *plugin);
+    bool (CLAP_ABI *set_active)(const clap_plugin *plugin, bool is_input, uint32_t port_index, bool is_active, uint32_t sample_size);
 };
 
 // convert parameter to normalized
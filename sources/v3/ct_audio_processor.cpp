@@ -3,12 +3,22 @@
 #include "ct_events.hpp"
 #include "ct_event_conversion.hpp"
 #include "ct_component_caches.hpp"
+#include "ct_process_plan.hpp"
+#include "ct_block_fifo.hpp"
+#include "ct_shared_buffers.hpp"
+#include "ct_fixed_layout.hpp"
 #include "ct_threads.hpp"
+#include "ct_logger.hpp"
+#include "ct_live_stats.hpp"
 #include "clap_helpers.hpp"
-#include "utility/ct_bump_allocator.hpp"
+#include "utility/ct_audio_kernels.hpp"
+#include "utility/ct_fp_state.hpp"
 #include "utility/ct_messages.hpp"
 #include "utility/ct_assert.hpp"
+#include <type_traits>
+#include <algorithm>
 #include <cstring>
+#include <cstdio>
 
 namespace ct {
 
@@ -50,6 +60,10 @@ v3_result V3_API ct_audio_processor::set_bus_arrangements(void *self_, v3_speake
     ct_audio_processor *self = (ct_audio_processor *)self_;
     ct_component *comp = self->m_comp;
 
+    // the arrangement is only changed while inactive
+    if (comp->m_active)
+        LOG_PLUGIN_RET(V3_FALSE);
+
     // check if we have a config that matches
     nonstd::span<const ct_caches::ports_config_t> configs = comp->m_cache->get_audio_ports_configs();
 
@@ -123,15 +137,12 @@ v3_result V3_API ct_audio_processor::can_process_sample_size(void *self_, int32_
 {
     LOG_PLUGIN_SELF_CALL(self_);
 
-    ct_audio_processor *self = (ct_audio_processor *)self_;
-    ct_component *comp = self->m_comp;
+    (void)self_;
 
-    if (symbolic_sample_size == V3_SAMPLE_32) {
+    // double precision is converted if the plugin does not support it
+    if (symbolic_sample_size == V3_SAMPLE_32 || symbolic_sample_size == V3_SAMPLE_64) {
         LOG_PLUGIN_RET(V3_TRUE);
     }
-    else if (symbolic_sample_size == V3_SAMPLE_64) {
-        return comp->m_cache->get_audio_ports()->m_can_do_64bit;
-    }
 
     LOG_PLUGIN_RET(V3_FALSE);
 }
@@ -140,6 +151,8 @@ uint32_t V3_API ct_audio_processor::get_latency_samples(void *self_)
 {
     LOG_PLUGIN_SELF_CALL(self_);
 
+    ct_thread_role_scope role{ct_thread_role_main};
+
     ct_audio_processor *self = (ct_audio_processor *)self_;
     ct_component *comp = self->m_comp;
     const clap_plugin *plug = comp->m_plug;
@@ -149,6 +162,9 @@ uint32_t V3_API ct_audio_processor::get_latency_samples(void *self_)
     if (latency)
         count = CLAP_CALL(latency, get, plug);
 
+    // the FIFOs delay by one block
+    count += CT_FIXED_BLOCK_SIZE;
+
     LOG_PLUGIN_RET(count);
 }
 
@@ -162,7 +178,7 @@ v3_result V3_API ct_audio_processor::setup_processing(void *self_, v3_process_se
     ct_component *comp = self->m_comp;
     const clap_plugin *plug = comp->m_plug;
 
-    if (!can_process_sample_size(self_, setup->symbolic_sample_size))
+    if (can_process_sample_size(self_, setup->symbolic_sample_size) != V3_TRUE)
         LOG_PLUGIN_RET(V3_FALSE);
 
     if (!std::memcmp(&comp->m_setup, setup, sizeof(v3_process_setup)))
@@ -194,9 +210,10 @@ v3_result V3_API ct_audio_processor::set_processing(void *self_, v3_bool state_)
     LOG_PLUGIN_RET(V3_TRUE);
 }
 
-static void clear_output_buffers(v3_process_data *data)
+// clear a range of frames of the outputs
+// the silence flags are set at the start of the block, and kept for the rest
+static void clear_output_buffers(v3_process_data *data, uint32_t offset, uint32_t nframes)
 {
-    uint32_t nframes = (uint32_t)data->nframes;
     if (nframes == 0)
         return;
 
@@ -204,24 +221,31 @@ static void clear_output_buffers(v3_process_data *data)
     for (uint32_t i_bus = 0; i_bus < num_bus; ++i_bus) {
         v3_audio_bus_buffers *bus = &data->outputs[i_bus];
         uint32_t num_ch = bus->num_channels;
-        bus->channel_silence_bitset = 0;
+        if (offset == 0)
+            bus->channel_silence_bitset = 0;
         for (uint32_t i_ch = 0; i_ch < num_ch; ++i_ch) {
             if (data->symbolic_sample_size == V3_SAMPLE_64) {
                 double *dst = bus->channel_buffers_64[i_ch];
                 if (dst)
-                    std::memset(dst, 0, nframes * sizeof(double));
+                    std::memset(dst + offset, 0, nframes * sizeof(double));
             }
             else {
                 CT_ASSERT(data->symbolic_sample_size == V3_SAMPLE_32);
                 float *dst = bus->channel_buffers_32[i_ch];
                 if (dst)
-                    std::memset(dst, 0, nframes * sizeof(float));
+                    std::memset(dst + offset, 0, nframes * sizeof(float));
             }
-            bus->channel_silence_bitset |= uint64_t{1} << i_ch;
+            if (offset == 0)
+                bus->channel_silence_bitset |= uint64_t{1} << i_ch;
         }
     }
 }
 
+static void clear_output_buffers(v3_process_data *data)
+{
+    clear_output_buffers(data, 0, (uint32_t)data->nframes);
+}
+
 ///
 static void process_parameters_before(ct_audio_processor *self, v3_process_data *data)
 {
@@ -254,160 +278,838 @@ static void process_parameters_after(ct_audio_processor *self, v3_process_data *
     conv->set_input(comp->m_output_events.get());
     conv->set_output((v3::param_changes *)data->output_params, (v3::event_list *)data->output_events);
     conv->transfer();
+
+#if CT_LIVE_STATS
+    if (ct_live_stats_slot *stats = comp->m_stats) {
+        ct_live_stats_add(stats->m_events_in, comp->m_input_events->count());
+        ct_live_stats_add(stats->m_events_out, comp->m_output_events->count());
+    }
+#endif
 }
 
 ///
-template <class T> T **&v3_buffer_ptrs(v3_audio_bus_buffers &ab);
-template <> inline float **&v3_buffer_ptrs<float>(v3_audio_bus_buffers &ab) { return ab.channel_buffers_32; }
-template <> inline double **&v3_buffer_ptrs<double>(v3_audio_bus_buffers &ab) { return ab.channel_buffers_64; }
+template <class Real>
+static Real *v3_channel_buffer(const v3_audio_bus_buffers *buses, int32_t num_buses, const ct_process_route &route, uint32_t offset)
+{
+    if (!buses || (int32_t)route.m_v3_bus >= num_buses)
+        return nullptr;
+    const v3_audio_bus_buffers &bus = buses[route.m_v3_bus];
+    Real **ptrs = v3_buffer_ptrs<Real>(bus);
+    if (!ptrs || (int32_t)route.m_v3_channel >= bus.num_channels)
+        return nullptr;
+    Real *buffer = ptrs[route.m_v3_channel];
+    return buffer ? (buffer + offset) : nullptr;
+}
 
-template <class T> T **v3_buffer_ptrs(const v3_audio_bus_buffers &ab);
-template <> inline float **v3_buffer_ptrs<float>(const v3_audio_bus_buffers &ab) { return ab.channel_buffers_32; }
-template <> inline double **v3_buffer_ptrs<double>(const v3_audio_bus_buffers &ab) { return ab.channel_buffers_64; }
+// whether the plugin can read the input from the host buffer without a copy
+// this is unsafe when the host has passed the same buffer to an output, unless
+// it's the same channel of the port declared as the in-place pair.
+template <class Real>
+static bool can_pass_input_directly(const ct_process_plan &plan, const v3_process_data *data, const ct_process_route &route, const Real *src, uint32_t offset)
+{
+#if CT_ZERO_COPY_INPUTS
+    for (const ct_process_route &output : plan.outputs().m_routes) {
+        if (v3_channel_buffer<Real>(data->outputs, data->num_output_buses, output, offset) != src)
+            continue;
+        if (output.m_clap_port != route.m_pair_port || output.m_clap_channel != route.m_clap_channel)
+            return false;
+    }
+    return true;
+#else
+    (void)plan;
+    (void)data;
+    (void)route;
+    (void)src;
+    (void)offset;
+    return false;
+#endif
+}
+
+// get the input buffer of the plugin, which is the host buffer if possible,
+// otherwise a copy, converted to the precision of the plugin
+template <class Real, class PlugReal>
+static PlugReal *transfer_input_buffer(const ct_process_plan &plan, const v3_process_data *data, uint32_t route_index, Real *src, uint32_t offset, uint32_t nframes)
+{
+    PlugReal *dst = plan.copy_buffer<PlugReal>(route_index);
+    if constexpr (std::is_same<Real, PlugReal>::value) {
+        if (can_pass_input_directly<Real>(plan, data, plan.inputs().m_routes[route_index], src, offset))
+            return src;
+        std::memcpy(dst, src, nframes * sizeof(Real));
+    }
+    else {
+        (void)data;
+        (void)offset;
+        convert_buffer(src, dst, nframes);
+    }
+    return dst;
+}
+
+// get the output buffer of the plugin, which is the host buffer if possible,
+// otherwise a scratch buffer, to convert when the processing is done
+template <class Real, class PlugReal>
+static PlugReal *output_buffer(const ct_process_plan &plan, uint32_t route_index, Real *dst)
+{
+    if (!dst)
+        return plan.trash_buffer<PlugReal>();
+    if constexpr (std::is_same<Real, PlugReal>::value) {
+        (void)route_index;
+        return dst;
+    }
+    else
+        return plan.convert_buffer<PlugReal>(route_index);
+}
 
 ///
-template <class Real>
-static void prepare_processing_buffers(ct_component *comp, v3_process_data *data, ct::bump_allocator *allocator, clap_process *clap_data)
+#if CT_SILENCE_STATISTICS
+static void count_silence_statistics(std::vector<ct_silence_statistics> &stats, uint32_t index, bool flagged)
 {
-    const ct_caches::ports_t *audio_ports = comp->m_cache->get_audio_ports();
+    if (index < (uint32_t)stats.size()) {
+        ct_silence_statistics &st = stats[index];
+        st.m_blocks += 1;
+        st.m_flagged += flagged;
+    }
+}
+#endif
 
-    uint32_t nframes = (uint32_t)data->nframes;
+///
+template <class Real, class PlugReal>
+static void prepare_processing_buffers(ct_component *comp, v3_process_data *data, uint32_t offset, uint32_t nframes, clap_process *clap_data)
+{
+    const ct_process_plan &plan = comp->m_plan;
 
     // inputs
-    uint32_t num_inputs = (uint32_t)audio_ports->m_inputs.size();
-    clap_audio_buffer *inputs = allocator->typed_alloc<clap_audio_buffer>(num_inputs);
-    CT_ASSERT(inputs);
+    const ct_process_plan::direction_t &inputs = plan.inputs();
+    clap_audio_buffer *input_buffers = inputs.buffers<PlugReal>();
+    PlugReal **input_slots = inputs.slots<PlugReal>();
+    uint32_t num_input_routes = (uint32_t)inputs.m_routes.size();
 
-    for (uint32_t p_idx = 0; p_idx < num_inputs; ++p_idx) {
-        clap_audio_buffer port_data{};
-        const ct_clap_port_info &port = audio_ports->m_inputs[p_idx];
-        uint32_t channel_count = port.channel_count;
+    for (uint32_t p_idx : inputs.m_active_ports)
+        input_buffers[p_idx].constant_mask = 0;
 
-        bool have_port = p_idx < (uint32_t)data->num_input_buses;
-        const v3_audio_bus_buffers *v3_port = (!have_port) ? nullptr : &data->inputs[p_idx];
+    for (uint32_t r_idx = 0; r_idx < num_input_routes; ++r_idx) {
+        const ct_process_route &route = inputs.m_routes[r_idx];
+        //
+        Real *src = v3_channel_buffer<Real>(data->inputs, data->num_input_buses, route, offset);
+        PlugReal *dst;
+        //
+        if (!src)
+            dst = plan.zero_buffer<PlugReal>();
+        else
+            dst = transfer_input_buffer<Real, PlugReal>(plan, data, r_idx, src, offset, nframes);
+        input_slots[route.m_slot] = dst;
+        //
+        bool constant = !src || buffer_is_constant(src, nframes);
+        if (constant)
+            input_buffers[route.m_clap_port].constant_mask |= (uint64_t)1 << route.m_clap_channel;
+#if CT_SILENCE_STATISTICS
+        count_silence_statistics(comp->m_input_silence_stats, r_idx, constant);
+#endif
+    }
 
-        audio_buffer_ptrs<Real>(port_data) = allocator->typed_alloc<Real *>(channel_count);
-        CT_ASSERT(audio_buffer_ptrs<Real>(port_data));
-        port_data.channel_count = channel_count;
+    clap_data->audio_inputs = input_buffers;
+    clap_data->audio_inputs_count = inputs.m_port_count;
 
-        for (uint32_t c_idx = 0; c_idx < channel_count; ++c_idx) {
-            bool have_channel = have_port && c_idx < (uint32_t)v3_port->num_channels;
-            uint32_t c_mapped = port.mapping.map_to_clap(c_idx);
-            //
-            Real *src = (!have_channel) ? nullptr : v3_buffer_ptrs<Real>(*v3_port)[c_idx];
-            Real *dst;
-            if (!src) have_channel = false;
-            //
-            if (!have_channel)
-                dst = (Real *)comp->m_zero_buffer.get();
+    // outputs
+    const ct_process_plan::direction_t &outputs = plan.outputs();
+    clap_audio_buffer *output_buffers = outputs.buffers<PlugReal>();
+    PlugReal **output_slots = outputs.slots<PlugReal>();
+    uint32_t num_output_routes = (uint32_t)outputs.m_routes.size();
+
+    for (uint32_t p_idx : outputs.m_active_ports)
+        output_buffers[p_idx].constant_mask = 0;
+
+    for (uint32_t r_idx = 0; r_idx < num_output_routes; ++r_idx) {
+        const ct_process_route &route = outputs.m_routes[r_idx];
+        //
+        Real *dst = v3_channel_buffer<Real>(data->outputs, data->num_output_buses, route, offset);
+        output_slots[route.m_slot] = output_buffer<Real, PlugReal>(plan, r_idx, dst);
+    }
+
+    clap_data->audio_outputs = output_buffers;
+    clap_data->audio_outputs_count = outputs.m_port_count;
+}
+
+// finish the output of a route, in the host buffer: sanitize, apply the bypass,
+// and flag the silence
+template <class Real>
+static void finish_output_route(ct_component *comp, v3_process_data *data, uint32_t offset, uint32_t nframes, uint32_t r_idx, const ct_process_route &route, Real *dst, bool constant)
+{
+    (void)comp;
+    (void)r_idx;
+#if CT_OUTPUT_SANITIZER
+    // the scan runs in host precision, after conversion, which may
+    // have produced its own infinities and subnormals
+    if (uint32_t found = sanitize_buffer(dst, nframes)) {
+        // a channel which blew up is unusable, rather than send clicks, mute it
+        if (found & sanitize_found_non_finite) {
+            std::memset(dst, 0, nframes * sizeof(Real));
+            ++comp->m_sanitizer_stats.m_non_finite;
+        }
+        else
+            ++comp->m_sanitizer_stats.m_subnormal;
+        constant = false;
+    }
+#endif
+#if CT_WRAPPER_BYPASS
+    if (!comp->m_bypass.is_transparent()) {
+        comp->m_bypass.mix(r_idx, dst, nframes);
+        constant = false;
+    }
+#endif
+    //
+    // the constant flag of the plugin does not prove silence,
+    // but together with a nonzero sample, it lets us skip the scan
+    bool silent = nframes < 1 ||
+        (!(constant && dst[0] != 0) && buffer_is_silent(dst, nframes));
+    uint64_t &silence_bitset = data->outputs[route.m_v3_bus].channel_silence_bitset;
+    if (silent && offset == 0)
+        silence_bitset |= (uint64_t)1 << route.m_v3_channel;
+    else if (!silent)
+        silence_bitset &= ~((uint64_t)1 << route.m_v3_channel);
+#if CT_SILENCE_STATISTICS
+    count_silence_statistics(comp->m_output_silence_stats, r_idx, silent);
+#endif
+}
+
+template <class Real, class PlugReal>
+static void release_processing_buffers(ct_component *comp, v3_process_data *data, uint32_t offset, uint32_t nframes, clap_process *clap_data)
+{
+    // transfer output buffers back to v3
+
+    const ct_process_plan::direction_t &outputs = comp->m_plan.outputs();
+    const clap_audio_buffer *output_buffers = clap_data->audio_outputs;
+    uint32_t num_output_routes = (uint32_t)outputs.m_routes.size();
+
+    // the silence flags are set at the start of the block,
+    // and cleared by any part of the block which is not silent
+    uint32_t num_buses = std::min((uint32_t)std::max(data->num_output_buses, 0), outputs.m_port_count);
+    for (uint32_t b_idx = 0; offset == 0 && b_idx < num_buses; ++b_idx)
+        data->outputs[b_idx].channel_silence_bitset = 0;
+
+    // outputs
+    for (uint32_t r_idx = 0; r_idx < num_output_routes; ++r_idx) {
+        const ct_process_route &route = outputs.m_routes[r_idx];
+        //
+        Real *dst = v3_channel_buffer<Real>(data->outputs, data->num_output_buses, route, offset);
+        if (!dst) {
+#if CT_SILENCE_STATISTICS
+            count_silence_statistics(comp->m_output_silence_stats, r_idx, true);
+#endif
+            continue;
+        }
+        //
+        if constexpr (!std::is_same<Real, PlugReal>::value)
+            convert_buffer(outputs.slots<PlugReal>()[route.m_slot], dst, nframes);
+        //
+        bool constant = output_buffers[route.m_clap_port].constant_mask & ((uint64_t)1 << route.m_clap_channel);
+        finish_output_route<Real>(comp, data, offset, nframes, r_idx, route, dst, constant);
+    }
+
+}
+
+template <class Real, class PlugReal>
+static bool prepare_generic_buffers(ct_component *comp, v3_process_data *data, uint32_t offset, uint32_t nframes, clap_process *clap_data)
+{
+    prepare_processing_buffers<Real, PlugReal>(comp, data, offset, nframes, clap_data);
+    return true;
+}
+
+template <class Real, class PlugReal>
+static constexpr ct_process_kernel generic_process_kernel{
+    &prepare_generic_buffers<Real, PlugReal>,
+    &release_processing_buffers<Real, PlugReal>,
+};
+
+const ct_process_kernel *ct_audio_processor::select_generic_kernel(const ct_component *comp, bool host_64bit)
+{
+    if (!host_64bit)
+        return &generic_process_kernel<float, float>;
+    else if (comp->m_plan.plugin_64bit())
+        return &generic_process_kernel<double, double>;
+    else
+        return &generic_process_kernel<double, float>;
+}
+
+///
+// the process path of a fixed layout: one main port in each direction, with
+// constant channel counts, which maps channels directly in the host precision
+template <class Real, uint32_t NumIn, uint32_t NumOut>
+static bool prepare_fixed_buffers(ct_component *comp, v3_process_data *data, uint32_t offset, uint32_t nframes, clap_process *clap_data)
+{
+    // the kernel is selected for the precision of the setup, which the host
+    // may not follow; the buffers would not be of the type which it accesses
+    constexpr bool kernel_64bit = std::is_same<Real, double>::value;
+    if ((data->symbolic_sample_size == V3_SAMPLE_64) != kernel_64bit)
+        return false;
+
+    // the host may still pass another arrangement, or miss buffers
+    Real **src = nullptr;
+    if constexpr (NumIn > 0) {
+        if (data->num_input_buses < 1 || data->inputs[0].num_channels < (int32_t)NumIn)
+            return false;
+        src = v3_buffer_ptrs<Real>(data->inputs[0]);
+        if (!src)
+            return false;
+        for (uint32_t c_idx = 0; c_idx < NumIn; ++c_idx) {
+            if (!src[c_idx])
+                return false;
+        }
+    }
+    if (data->num_output_buses < 1 || data->outputs[0].num_channels < (int32_t)NumOut)
+        return false;
+    Real **dst = v3_buffer_ptrs<Real>(data->outputs[0]);
+    if (!dst)
+        return false;
+    for (uint32_t c_idx = 0; c_idx < NumOut; ++c_idx) {
+        if (!dst[c_idx])
+            return false;
+    }
+
+    const ct_process_plan &plan = comp->m_plan;
+
+    // inputs
+    const ct_process_plan::direction_t &inputs = plan.inputs();
+    clap_audio_buffer *input_buffers = inputs.buffers<Real>();
+    Real **input_slots = inputs.slots<Real>();
+
+    if constexpr (NumIn > 0) {
+        // an input shared with an output is passed directly only if it's the
+        // same channel of the in-place pair
+        bool paired = inputs.m_routes[0].m_pair_port == 0;
+        uint64_t constant_mask = 0;
+        for (uint32_t c_idx = 0; c_idx < NumIn; ++c_idx) {
+            Real *in = src[c_idx] + offset;
+            bool direct = CT_ZERO_COPY_INPUTS != 0;
+            for (uint32_t o_idx = 0; o_idx < NumOut; ++o_idx)
+                direct = direct && (dst[o_idx] + offset != in || (paired && o_idx == c_idx));
+            if (direct)
+                input_slots[c_idx] = in;
             else {
-                dst = allocator->typed_alloc<Real>(nframes);
-                CT_ASSERT(dst);
-                std::memcpy(dst, src, nframes * sizeof(Real));
+                Real *copy = plan.copy_buffer<Real>(c_idx);
+                std::memcpy(copy, in, nframes * sizeof(Real));
+                input_slots[c_idx] = copy;
             }
-            audio_buffer_ptrs<Real>(port_data)[c_mapped] = dst;
-            //
-            bool silent = !have_channel || nframes < 1 ||
-                ((v3_port->channel_silence_bitset & ((uint64_t)1 << c_idx)) && (src[0] == 0));
-            if (silent)
-                port_data.constant_mask |= (uint64_t)1 << c_mapped;
+            bool constant = buffer_is_constant(in, nframes);
+            constant_mask |= (uint64_t)constant << c_idx;
+#if CT_SILENCE_STATISTICS
+            count_silence_statistics(comp->m_input_silence_stats, c_idx, constant);
+#endif
         }
-
-        inputs[p_idx] = port_data;
+        input_buffers[0].constant_mask = constant_mask;
     }
 
-    clap_data->audio_inputs = inputs;
-    clap_data->audio_inputs_count = num_inputs;
+    clap_data->audio_inputs = input_buffers;
+    clap_data->audio_inputs_count = inputs.m_port_count;
 
     // outputs
-    uint32_t num_outputs = (uint32_t)audio_ports->m_outputs.size();
-    clap_audio_buffer *outputs = allocator->typed_alloc<clap_audio_buffer>(num_outputs);
-    CT_ASSERT(outputs);
+    const ct_process_plan::direction_t &outputs = plan.outputs();
+    clap_audio_buffer *output_buffers = outputs.buffers<Real>();
+    Real **output_slots = outputs.slots<Real>();
 
-    for (uint32_t p_idx = 0; p_idx < num_outputs; ++p_idx) {
-        clap_audio_buffer port_data{};
-        const ct_clap_port_info &port = audio_ports->m_outputs[p_idx];
-        uint32_t channel_count = port.channel_count;
+    for (uint32_t c_idx = 0; c_idx < NumOut; ++c_idx)
+        output_slots[c_idx] = dst[c_idx] + offset;
+    output_buffers[0].constant_mask = 0;
 
-        bool have_port = p_idx < (uint32_t)data->num_output_buses;
-        const v3_audio_bus_buffers *v3_port = (!have_port) ? nullptr : &data->outputs[p_idx];
+    clap_data->audio_outputs = output_buffers;
+    clap_data->audio_outputs_count = outputs.m_port_count;
+    return true;
+}
 
-        audio_buffer_ptrs<Real>(port_data) = allocator->typed_alloc<Real *>(channel_count);
-        CT_ASSERT(audio_buffer_ptrs<Real>(port_data));
-        port_data.channel_count = channel_count;
+template <class Real, uint32_t NumIn, uint32_t NumOut>
+static void release_fixed_buffers(ct_component *comp, v3_process_data *data, uint32_t offset, uint32_t nframes, clap_process *clap_data)
+{
+    const ct_process_plan::direction_t &outputs = comp->m_plan.outputs();
+    uint64_t constant_mask = clap_data->audio_outputs[0].constant_mask;
+    Real **dst = v3_buffer_ptrs<Real>(data->outputs[0]);
 
-        for (uint32_t c_idx = 0; c_idx < channel_count; ++c_idx) {
-            bool have_channel = have_port && c_idx < (uint32_t)v3_port->num_channels;
-            uint32_t c_mapped = port.mapping.map_to_clap(c_idx);
-            //
-            Real *src = (!have_channel) ? nullptr : v3_buffer_ptrs<Real>(*v3_port)[c_idx];
-            Real *dst;
-            if (!src) have_channel = false;
-            //
-            if (!have_channel)
-                dst = (Real *)comp->m_trash_buffer.get();
-            else
-                dst = src;
-            audio_buffer_ptrs<Real>(port_data)[c_mapped] = dst;
+    if (offset == 0)
+        data->outputs[0].channel_silence_bitset = 0;
+
+    for (uint32_t c_idx = 0; c_idx < NumOut; ++c_idx) {
+        bool constant = constant_mask & ((uint64_t)1 << c_idx);
+        finish_output_route<Real>(comp, data, offset, nframes, c_idx, outputs.m_routes[c_idx], dst[c_idx] + offset, constant);
+    }
+
+}
+
+template <class Real, uint32_t NumIn, uint32_t NumOut>
+static constexpr ct_process_kernel fixed_process_kernel{
+    &prepare_fixed_buffers<Real, NumIn, NumOut>,
+    &release_fixed_buffers<Real, NumIn, NumOut>,
+};
+
+// the layouts which have a specialized path, keep in sync with `cmake.v3.txt`
+static const struct {
+    uint32_t m_inputs;
+    uint32_t m_outputs;
+    const ct_process_kernel *m_kernel32;
+    const ct_process_kernel *m_kernel64;
+} fixed_process_kernels[] = {
+    {0, 1, &fixed_process_kernel<float, 0, 1>, &fixed_process_kernel<double, 0, 1>},
+    {0, 2, &fixed_process_kernel<float, 0, 2>, &fixed_process_kernel<double, 0, 2>},
+    {1, 1, &fixed_process_kernel<float, 1, 1>, &fixed_process_kernel<double, 1, 1>},
+    {1, 2, &fixed_process_kernel<float, 1, 2>, &fixed_process_kernel<double, 1, 2>},
+    {2, 2, &fixed_process_kernel<float, 2, 2>, &fixed_process_kernel<double, 2, 2>},
+};
+
+// whether the direction has a single port, active, mapping channels directly
+static bool is_fixed_direction(const ct_process_plan::direction_t &dir, uint32_t num_channels)
+{
+    if (num_channels == 0)
+        return dir.m_port_count == 0;
+    if (dir.m_port_count != 1 || dir.m_routes.size() != num_channels)
+        return false;
+    for (uint32_t r_idx = 0; r_idx < num_channels; ++r_idx) {
+        const ct_process_route &route = dir.m_routes[r_idx];
+        if (route.m_slot != r_idx || route.m_v3_bus != 0 || route.m_v3_channel != r_idx)
+            return false;
+    }
+    return true;
+}
+
+const ct_process_kernel *ct_audio_processor::select_fixed_kernel(const ct_component *comp, bool host_64bit)
+{
+    const ct_fixed_layout &layout = ct_plugin_fixed_layout;
+    if (!layout.enabled())
+        return nullptr;
+
+    const ct_process_plan &plan = comp->m_plan;
+    if (plan.empty() || plan.converts())
+        return nullptr;
+    if (layout.m_sample_size != 0 && layout.m_sample_size != (host_64bit ? 64u : 32u))
+        return nullptr;
+    if (!is_fixed_direction(plan.inputs(), layout.m_inputs) || !is_fixed_direction(plan.outputs(), layout.m_outputs))
+        return nullptr;
+
+    for (const auto &entry : fixed_process_kernels) {
+        if (entry.m_inputs == layout.m_inputs && entry.m_outputs == layout.m_outputs)
+            return host_64bit ? entry.m_kernel64 : entry.m_kernel32;
+    }
+    return nullptr;
+}
+
+///
+// whether the inputs are silent, from the flags of the host, or the contents
+template <class Real>
+static bool inputs_are_quiet(const ct_component *comp, const v3_process_data *data, uint32_t offset, uint32_t nframes)
+{
+    const ct_process_plan::direction_t &inputs = comp->m_plan.inputs();
+
+    for (const ct_process_route &route : inputs.m_routes) {
+        const Real *src = v3_channel_buffer<Real>(data->inputs, data->num_input_buses, route, offset);
+        if (!src)
+            continue;
+        if (data->inputs[route.m_v3_bus].channel_silence_bitset & ((uint64_t)1 << route.m_v3_channel))
+            continue;
+        if (!buffer_is_silent(src, nframes))
+            return false;
+    }
+    return true;
+}
+
+// whether the outputs are silent, after the flags are computed
+template <class Real>
+static bool outputs_are_quiet(const ct_component *comp, const v3_process_data *data)
+{
+    const ct_process_plan::direction_t &outputs = comp->m_plan.outputs();
+
+    for (const ct_process_route &route : outputs.m_routes) {
+        if (!v3_channel_buffer<Real>(data->outputs, data->num_output_buses, route, 0))
+            continue;
+        if (!(data->outputs[route.m_v3_bus].channel_silence_bitset & ((uint64_t)1 << route.m_v3_channel)))
+            return false;
+    }
+    return true;
+}
+
+// compute the silence flags of the outputs, from the contents
+template <class Real>
+static void flag_silent_outputs(v3_process_data *data)
+{
+    uint32_t nframes = (uint32_t)data->nframes;
+
+    uint32_t num_bus = (uint32_t)std::max(data->num_output_buses, 0);
+    for (uint32_t i_bus = 0; i_bus < num_bus; ++i_bus) {
+        v3_audio_bus_buffers *bus = &data->outputs[i_bus];
+        Real **ptrs = v3_buffer_ptrs<Real>(*bus);
+        uint32_t num_ch = (uint32_t)std::max(bus->num_channels, 0);
+        bus->channel_silence_bitset = 0;
+        for (uint32_t i_ch = 0; i_ch < num_ch; ++i_ch) {
+            const Real *buffer = ptrs ? ptrs[i_ch] : nullptr;
+            if (!buffer || buffer_is_silent(buffer, nframes))
+                bus->channel_silence_bitset |= uint64_t{1} << i_ch;
         }
+    }
+}
 
-        outputs[p_idx] = port_data;
+///
+#if CT_WRAPPER_BYPASS
+// follow the changes of the bypass parameter, in the input events
+static void update_bypass_state(ct_component *comp, const clap_input_events *in_events)
+{
+    ct_bypass_engine &bypass = comp->m_bypass;
+
+    for (uint32_t i = 0, n = in_events->size(in_events); i < n; ++i) {
+        const clap_event_header *hdr = in_events->get(in_events, i);
+        if (hdr->space_id != CLAP_CORE_EVENT_SPACE_ID || hdr->type != CLAP_EVENT_PARAM_VALUE)
+            continue;
+        const clap_event_param_value *ev = (const clap_event_param_value *)hdr;
+        if (ev->param_id == bypass.param_id())
+            bypass.set_bypassed(ev->value >= 0.5);
     }
+}
+
+// feed the delay lines, before the plugin has a chance to overwrite inputs
+// the dry signal of an output is the input of the same bus and channel
+template <class Real>
+static void capture_bypass_inputs(ct_component *comp, const v3_process_data *data, uint32_t offset, uint32_t nframes)
+{
+    const ct_process_plan::direction_t &outputs = comp->m_plan.outputs();
+    uint32_t num_output_routes = (uint32_t)outputs.m_routes.size();
 
-    clap_data->audio_outputs = outputs;
-    clap_data->audio_outputs_count = num_outputs;
+    for (uint32_t r_idx = 0; r_idx < num_output_routes; ++r_idx) {
+        const Real *src = v3_channel_buffer<Real>(data->inputs, data->num_input_buses, outputs.m_routes[r_idx], offset);
+        comp->m_bypass.capture(r_idx, src, nframes);
+    }
 }
 
+// produce the outputs without running the plugin
 template <class Real>
-static void release_processing_buffers(ct_component *comp, v3_process_data *data, ct::bump_allocator *allocator, clap_process *clap_data)
+static void process_bypassed_buffers(ct_component *comp, v3_process_data *data, uint32_t offset, uint32_t nframes)
 {
-    // transfer output buffers back to v3
+    const ct_process_plan::direction_t &outputs = comp->m_plan.outputs();
+    uint32_t num_output_routes = (uint32_t)outputs.m_routes.size();
+
+    clear_output_buffers(data, offset, nframes);
+
+    for (uint32_t r_idx = 0; r_idx < num_output_routes; ++r_idx) {
+        const ct_process_route &route = outputs.m_routes[r_idx];
+        Real *dst = v3_channel_buffer<Real>(data->outputs, data->num_output_buses, route, offset);
+        if (!dst)
+            continue;
+        comp->m_bypass.mix(r_idx, dst, nframes);
+        if (!buffer_is_silent(dst, nframes))
+            data->outputs[route.m_v3_bus].channel_silence_bitset &= ~((uint64_t)1 << route.m_v3_channel);
+    }
+}
+#endif
+
+///
+// process a range of frames of the buffers, with a single call of the plugin
+static clap_process_status process_block(ct_audio_processor *self, v3_process_data *data, uint32_t offset, uint32_t nframes, const clap_input_events *in_events, const clap_output_events *out_events)
+{
+    ct_component *comp = self->m_comp;
+    const clap_plugin *plug = comp->m_plug;
+    const clap_plugin_params *params = comp->m_ext.m_params;
+    bool host_64bit = data->symbolic_sample_size == V3_SAMPLE_64;
+
+#if CT_WRAPPER_BYPASS
+    ct_bypass_engine &bypass = comp->m_bypass;
+    if (bypass.enabled()) {
+        update_bypass_state(comp, in_events);
+        if (host_64bit)
+            capture_bypass_inputs<double>(comp, data, offset, nframes);
+        else
+            capture_bypass_inputs<float>(comp, data, offset, nframes);
+        // the delay lines terminate the block, on any path which follows
+        auto bypass_guard = defer([&bypass, nframes]() { bypass.advance(nframes); });
+        // skip the plugin, and just give it the parameter changes
+        if (bypass.is_bypassed()) {
+            if (params)
+                CLAP_CALL(params, flush, plug, in_events, out_events);
+            if (host_64bit)
+                process_bypassed_buffers<double>(comp, data, offset, nframes);
+            else
+                process_bypassed_buffers<float>(comp, data, offset, nframes);
+            comp->m_bypass_skipped = true;
+            return CLAP_PROCESS_CONTINUE;
+        }
+        // resume from a clean state, the plugin has missed some audio
+        if (comp->m_bypass_skipped) {
+            CLAP_CALL(plug, reset, plug);
+            comp->m_bypass_skipped = false;
+            comp->m_sleep.reset();
+        }
+    }
+#endif
+
+#if CT_LIVE_STATS
+    ct_live_stats_slot *stats = comp->m_stats;
+    if (stats)
+        ct_live_stats_add(stats->m_blocks, 1);
+#endif
+
+    // while the plugin sleeps, output silence until there is something to do
+    ct_sleep_state &sleep = comp->m_sleep;
+    bool input_quiet = false;
+    if (sleep.is_sleeping() || sleep.tracks_input()) {
+        input_quiet = host_64bit ?
+            inputs_are_quiet<double>(comp, data, offset, nframes) :
+            inputs_are_quiet<float>(comp, data, offset, nframes);
+    }
+    if (sleep.is_sleeping()) {
+        if (in_events->size(in_events) == 0 && input_quiet) {
+            clear_output_buffers(data, offset, nframes);
+#if CT_LIVE_STATS
+            if (stats)
+                ct_live_stats_add(stats->m_sleeping_blocks, 1);
+#endif
+            return CLAP_PROCESS_SLEEP;
+        }
+        sleep.wake();
+        input_quiet = false;
+    }
 
-    const ct_caches::ports_t *audio_ports = comp->m_cache->get_audio_ports();
+    // the transient buffers come from an arena shared with other instances,
+    // there is none only past the maximum of arenas; the plugin still gets
+    // the events, so that it does not miss note ends or parameter changes
+    ct_scratch_lease scratch;
+    if (!scratch) {
+        if (params)
+            CLAP_CALL(params, flush, plug, in_events, out_events);
+        clear_output_buffers(data, offset, nframes);
+        return CLAP_PROCESS_CONTINUE;
+    }
+    comp->m_plan.bind_scratch(scratch.data());
 
-    const std::vector<ct_clap_port_info> &ports = audio_ports->m_outputs;
-    uint32_t num_outputs = (uint32_t)ports.size();
-    clap_audio_buffer *outputs = clap_data->audio_outputs;
+    //
+    clap_process clap_data{};
+    clap_data.steady_time = -1;
+    clap_data.frames_count = nframes;
+    clap_data.transport = &comp->m_transport;
+    const ct_process_kernel *kernel = comp->m_fixed_kernel;
+    if (!kernel || !kernel->prepare(comp, data, offset, nframes, &clap_data)) {
+        kernel = ct_audio_processor::select_generic_kernel(comp, host_64bit);
+        kernel->prepare(comp, data, offset, nframes, &clap_data);
+    }
+    clap_data.in_events = in_events;
+    clap_data.out_events = out_events;
+    clap_process_status clap_status;
+    {
+#if CT_OUTPUT_SANITIZER
+        scoped_flush_denormals flush_denormals;
+#endif
+#if CT_PROCESS_TIMING
+        uint64_t plugin_start = ct_process_timing::now();
+#endif
+        clap_status = CLAP_CALL(plug, process, plug, &clap_data);
+#if CT_PROCESS_TIMING
+        comp->m_timing.add_plugin_time(ct_process_timing::now() - plugin_start);
+#endif
+    }
+    kernel->release(comp, data, offset, nframes, &clap_data);
+
+    //
+    const clap_plugin_tail *tail = comp->m_ext.m_tail;
+    bool output_quiet = false;
+    if (clap_status == CLAP_PROCESS_CONTINUE_IF_NOT_QUIET)
+        output_quiet = host_64bit ? outputs_are_quiet<double>(comp, data) : outputs_are_quiet<float>(comp, data);
+    uint32_t tail_samples = (tail && clap_status == CLAP_PROCESS_TAIL) ? CLAP_CALL(tail, get, plug) : 0;
+    sleep.update(clap_status, input_quiet, output_quiet, tail_samples, nframes);
+
+    return clap_status;
+}
+
+// process a host block larger than the plugin accepts, in several parts
+// each part receives the input events in its range, with times made relative
+static clap_process_status process_split_blocks(ct_audio_processor *self, v3_process_data *data)
+{
+    ct_component *comp = self->m_comp;
+    ct_events_buffer *input_events = comp->m_input_events.get();
+    ct_events_buffer *block_events = comp->m_block_events.get();
+    ct_events_buffer *output_events = comp->m_output_events.get();
+    const clap_input_events clap_evts_in = block_events->as_clap_input();
+    const clap_output_events clap_evts_out = output_events->as_clap_output();
 
     uint32_t nframes = (uint32_t)data->nframes;
+    uint32_t max_frames = comp->m_plan.max_frames();
+    nonstd::span<const clap_event_header *const> events = input_events->events();
+    uint32_t e_idx = 0;
+    uint32_t e_count = (uint32_t)events.size();
+    clap_process_status status = CLAP_PROCESS_CONTINUE;
+
+    for (uint32_t offset = 0; offset < nframes; offset += max_frames) {
+        uint32_t frames = std::min(max_frames, nframes - offset);
+        bool last = offset + frames == nframes;
+        //
+        block_events->clear();
+        block_events->set_time_offset(-(int32_t)offset);
+        for (; e_idx < e_count; ++e_idx) {
+            const clap_event_header *hdr = events[e_idx];
+            if (!last && hdr->time >= offset + frames)
+                break;
+            block_events->add(hdr);
+        }
+        //
+        output_events->set_time_offset((int32_t)offset);
+        if (process_block(self, data, offset, frames, &clap_evts_in, &clap_evts_out) == CLAP_PROCESS_ERROR)
+            status = CLAP_PROCESS_ERROR;
+    }
 
-    // outputs
-    for (uint32_t p_idx = 0; p_idx < num_outputs; ++p_idx) {
-        const clap_audio_buffer &port_data = outputs[p_idx];
-        const ct_clap_port_info &port = ports[p_idx];
-        uint32_t channel_count = port.channel_count;
+    block_events->clear();
+    block_events->set_time_offset(0);
+    output_events->set_time_offset(0);
+    return status;
+}
 
-        bool have_port = p_idx < (uint32_t)data->num_output_buses;
-        v3_audio_bus_buffers *v3_port = (!have_port) ? nullptr : &data->outputs[p_idx];
+// send the delayed output events which come out before the given frame
+static void send_delayed_events(ct_component *comp, uint32_t until)
+{
+    ct_events_buffer *delayed_events = comp->m_delayed_events.get();
+    ct_events_buffer *output_events = comp->m_output_events.get();
+    nonstd::span<const clap_event_header *const> events = delayed_events->events();
+    uint32_t e_idx = comp->m_delayed_index;
+    uint32_t e_count = (uint32_t)events.size();
+    int64_t start = comp->m_delayed_start;
+
+    output_events->set_time_offset((int32_t)start);
+    for (; e_idx < e_count; ++e_idx) {
+        const clap_event_header *hdr = events[e_idx];
+        if (start + hdr->time >= until)
+            break;
+        output_events->add(hdr);
+    }
+    output_events->set_time_offset(0);
 
-        v3_port->channel_silence_bitset = 0;
+    comp->m_delayed_index = e_idx;
+}
 
-        for (uint32_t c_idx = 0; c_idx < channel_count; ++c_idx) {
-            bool have_channel = have_port && c_idx < (uint32_t)v3_port->num_channels;
-            uint32_t c_mapped = port.mapping.map_to_clap(c_idx);
-            //
-            Real *dst = (!have_channel) ? nullptr : v3_buffer_ptrs<Real>(*v3_port)[c_idx];
-            //Real *src = audio_buffer_ptrs<Real>(port_data)[c_mapped];
-            if (!dst) have_channel = false;
+// process the host block through the FIFOs, in blocks of fixed size
+// the input events go along with the audio, to the block which receives
+// their frame; the output events are delayed like the audio, by a block,
+// and go to the frames where the audio of their block comes out
+template <class Real>
+static clap_process_status process_fixed_blocks(ct_audio_processor *self, v3_process_data *data)
+{
+    ct_component *comp = self->m_comp;
+    ct_block_fifo &fifo = comp->m_fifo;
+    ct_events_buffer *input_events = comp->m_input_events.get();
+    ct_events_buffer *block_events = comp->m_block_events.get();
+    ct_events_buffer *delayed_events = comp->m_delayed_events.get();
+    const clap_input_events clap_evts_in = block_events->as_clap_input();
+    const clap_output_events clap_evts_out = delayed_events->as_clap_output();
+
+    uint32_t nframes = (uint32_t)data->nframes;
+    uint32_t block_size = fifo.block_size();
+    nonstd::span<const clap_event_header *const> events = input_events->events();
+    uint32_t e_idx = 0;
+    uint32_t e_count = (uint32_t)events.size();
+    clap_process_status status = CLAP_PROCESS_CONTINUE;
+
+    for (uint32_t offset = 0; offset < nframes; ) {
+        uint32_t position = fifo.position();
+        uint32_t frames = std::min(nframes - offset, block_size - position);
+        bool last = offset + frames == nframes;
+        //
+        block_events->set_time_offset((int32_t)position - (int32_t)offset);
+        for (; e_idx < e_count; ++e_idx) {
+            const clap_event_header *hdr = events[e_idx];
+            if (!last && hdr->time >= offset + frames)
+                break;
+            block_events->add(hdr);
+        }
+        //
+        bool complete = fifo.exchange<Real>(data, offset, frames);
+        offset += frames;
+        if (complete) {
+            // the previous block is out, and this one comes out from here
+            send_delayed_events(comp, offset);
+            delayed_events->clear();
+            comp->m_delayed_index = 0;
+            comp->m_delayed_start = (int32_t)offset;
             //
-            bool silent = !have_channel || nframes < 1 ||
-                ((port_data.constant_mask & ((uint64_t)1 << c_mapped)) && (dst[0] == 0));
-            if (silent)
-                v3_port->channel_silence_bitset |= (uint64_t)1 << c_idx;
+            v3_process_data *block_data = fifo.block_data(data);
+            if (process_block(self, block_data, 0, block_size, &clap_evts_in, &clap_evts_out) == CLAP_PROCESS_ERROR)
+                status = CLAP_PROCESS_ERROR;
+            block_events->clear();
         }
     }
+
+    block_events->set_time_offset(0);
+
+    // the rest of the block comes out in the next host blocks
+    send_delayed_events(comp, nframes);
+    comp->m_delayed_start -= (int32_t)nframes;
+
+    flag_silent_outputs<Real>(data);
+    return status;
+}
+
+#if CT_PROCESS_TIMING
+// the deadline misses are logged at 1, 2, 4, 8... so that they do not flood
+// the offline renders may be slower than real time, and miss no deadline
+static void record_process_timing(ct_component *comp, uint64_t elapsed, uint32_t nframes, bool realtime)
+{
+    double load = comp->m_timing.record(elapsed, nframes, realtime);
+    if (load <= 1.0)
+        return;
+
+    uint64_t misses = comp->m_timing.over_budget();
+    if ((misses & (misses - 1)) == 0) {
+        char text[128];
+        std::snprintf(text, sizeof(text), "Deadline missed, %d%% of the budget of %u frames (%llu misses)",
+                      (int)(load * 100), nframes, (unsigned long long)misses);
+        ct_logger::instance().log(CLAP_LOG_WARNING, comp->m_desc ? comp->m_desc->name : nullptr, text);
+    }
+}
+#endif
+
+#if CT_LIVE_STATS
+static void publish_process_stats(ct_component *comp, uint64_t elapsed)
+{
+    ct_live_stats_slot *stats = comp->m_stats;
+    if (!stats)
+        return;
+
+    ct_live_stats_add(stats->m_process_calls, 1);
+    ct_live_stats_add(stats->m_process_ns, elapsed);
+    ct_live_stats_max(stats->m_process_max_ns, elapsed);
+
+    uint64_t dropped = comp->m_input_events->dropped() + comp->m_output_events->dropped() +
+        comp->m_block_events->dropped() + comp->m_delayed_events->dropped();
+    stats->m_events_dropped.store(dropped, std::memory_order_relaxed);
 }
+#endif
+
+#if CT_PROCESS_TIMING || CT_LIVE_STATS
+// measure the call at the end of `process`, whichever way it returns
+static void finish_process_timing(ct_component *comp, uint64_t start, uint32_t nframes, bool realtime)
+{
+    uint64_t elapsed = ct_process_timing::now() - start;
+#if CT_PROCESS_TIMING
+    record_process_timing(comp, elapsed, nframes, realtime);
+#else
+    (void)nframes;
+    (void)realtime;
+#endif
+#if CT_LIVE_STATS
+    publish_process_stats(comp, elapsed);
+#endif
+}
+#endif
 
 ///
 v3_result V3_API ct_audio_processor::process(void *self_, v3_process_data *data)
 {
     LOG_PLUGIN_SELF_CALL(self_);
 
+    ct_thread_role_scope role{ct_thread_role_audio};
+#if CT_RT_AUDIT
+    rt_audit_scope audit;
+#endif
+
     ct_audio_processor *self = (ct_audio_processor *)self_;
     ct_component *comp = self->m_comp;
     const clap_plugin *plug = comp->m_plug;
     const clap_plugin_params *params = comp->m_ext.m_params;
 
+#if CT_PROCESS_TIMING || CT_LIVE_STATS
+    uint64_t start = ct_process_timing::now();
+    auto timing_guard = defer([comp, data, start]() {
+        finish_process_timing(comp, start, (uint32_t)std::max(data->nframes, 0), data->process_mode == V3_REALTIME);
+    });
+#endif
+
     // call `start_processing` and `stop_processing` here
     // there are [audio-thread] in CLAP but more permissive in VST
     if (comp->m_should_process) {
@@ -416,6 +1118,12 @@ v3_result V3_API ct_audio_processor::process(void *self_, v3_process_data *data)
                 comp->m_processing_status = ct_component::errored;
             else {
                 CLAP_CALL(plug, reset, plug);
+                comp->m_sleep.reset();
+                comp->m_fifo.reset();
+                comp->m_block_events->clear();
+                comp->m_delayed_events->clear();
+                comp->m_delayed_index = 0;
+                comp->m_delayed_start = 0;
                 comp->m_processing_status = ct_component::started;
             }
         }
@@ -441,33 +1149,33 @@ v3_result V3_API ct_audio_processor::process(void *self_, v3_process_data *data)
         LOG_PLUGIN_RET((comp->m_processing_status != ct_component::errored) ? V3_OK : V3_FALSE);
     }
 
-    //TODO: in-place processing optimizations
     #pragma message("TODO: parameter flushing")
 
+    // the buffers are planned for the precision given at setup
+    bool host_64bit = data->symbolic_sample_size == V3_SAMPLE_64;
+    bool precision_ok = comp->m_fifo.enabled() ?
+        (host_64bit == comp->m_fifo.is_64bit()) :
+        (!host_64bit || comp->m_plan.plugin_64bit() || comp->m_plan.converts());
+    if (!precision_ok) {
+        clear_output_buffers(data);
+        LOG_PLUGIN_RET(V3_FALSE);
+    }
+
     //
     process_parameters_before(self, data);
-    const clap_input_events clap_evts_in = comp->m_input_events->as_clap_input();
-    const clap_output_events clap_evts_out = comp->m_output_events->as_clap_output();
 
-    //
-    ct::bump_allocator allocator{comp->m_dynamic_buffers.get(), comp->m_dynamic_capacity};
+    uint32_t nframes = (uint32_t)data->nframes;
+    clap_process_status clap_status;
+    if (comp->m_fifo.enabled())
+        clap_status = host_64bit ? process_fixed_blocks<double>(self, data) : process_fixed_blocks<float>(self, data);
+    else if (nframes > comp->m_plan.max_frames() && comp->m_plan.max_frames() > 0)
+        clap_status = process_split_blocks(self, data);
+    else {
+        const clap_input_events clap_evts_in = comp->m_input_events->as_clap_input();
+        const clap_output_events clap_evts_out = comp->m_output_events->as_clap_output();
+        clap_status = process_block(self, data, 0, nframes, &clap_evts_in, &clap_evts_out);
+    }
 
-    //
-    clap_process clap_data{};
-    clap_data.steady_time = -1;
-    clap_data.frames_count = (uint32_t)data->nframes;
-    clap_data.transport = &comp->m_transport;
-    if (data->symbolic_sample_size == V3_SAMPLE_64)
-        prepare_processing_buffers<double>(comp, data, &allocator, &clap_data);
-    else
-        prepare_processing_buffers<float>(comp, data, &allocator, &clap_data);
-    clap_data.in_events = &clap_evts_in;
-    clap_data.out_events = &clap_evts_out;
-    clap_process_status clap_status = CLAP_CALL(plug, process, plug, &clap_data);
-    if (data->symbolic_sample_size == V3_SAMPLE_64)
-        release_processing_buffers<double>(comp, data, &allocator, &clap_data);
-    else
-        release_processing_buffers<float>(comp, data, &allocator, &clap_data);
     process_parameters_after(self, data);
 
     LOG_PLUGIN_RET((clap_status == CLAP_PROCESS_ERROR) ? V3_FALSE : V3_TRUE);
@@ -477,6 +1185,8 @@ uint32_t V3_API ct_audio_processor::get_tail_samples(void *self_)
 {
     LOG_PLUGIN_SELF_CALL(self_);
 
+    ct_thread_role_scope role{ct_thread_role_main};
+
     ct_audio_processor *self = (ct_audio_processor *)self_;
     ct_component *comp = self->m_comp;
     const clap_plugin *plug = comp->m_plug;
@@ -1,6 +1,7 @@
 #pragma once
 #include "ct_defs.hpp"
 #include "travesty_helpers.hpp"
+#include <clap/clap.h>
 #include <travesty/component.h>
 #include <travesty/audio_processor.h>
 
@@ -8,6 +9,17 @@ namespace ct {
 
 struct ct_component;
 
+// A process path, which sets up the buffers of a block for the plugin, and
+// transfers its outputs back to the host. A path specialized for a fixed
+// layout replaces the generic path.
+// NOTE: `prepare` of a specialized path returns false if the host data does
+//       not fit the layout or the precision of the kernel, then the block is
+//       processed by the generic path, which always accepts it
+struct ct_process_kernel {
+    bool (*prepare)(ct_component *comp, v3_process_data *data, uint32_t offset, uint32_t nframes, clap_process *clap_data);
+    void (*release)(ct_component *comp, v3_process_data *data, uint32_t offset, uint32_t nframes, clap_process *clap_data);
+};
+
 // A subobject of `ct_component`
 struct ct_audio_processor {
     ct_audio_processor() = default;
@@ -27,6 +39,13 @@ struct ct_audio_processor {
     static v3_result V3_API process(void *self, v3_process_data *data);
     static uint32_t V3_API get_tail_samples(void *self);
 
+    //--------------------------------------------------------------------------
+    // get the specialized path for the layout of the plugin, if it has one,
+    // and if the active configuration matches it
+    static const ct_process_kernel *select_fixed_kernel(const ct_component *comp, bool host_64bit);
+    // get the generic path, for the active configuration
+    static const ct_process_kernel *select_generic_kernel(const ct_component *comp, bool host_64bit);
+
     //--------------------------------------------------------------------------
     static const struct vtable {
         const v3_funknown i_unk {
@@ -0,0 +1,123 @@
+#pragma once
+#include "ct_defs.hpp"
+#include <clap/clap.h>
+#include <cmath>
+#include <cstdint>
+
+namespace ct {
+
+// Reduces the automation points of a parameter, given in normalized values.
+// - points at the same offset are merged, keeping the last value
+// - points in the middle of a linear ramp are dropped, keeping the endpoints
+// - points which repeat the previous value of the block are dropped
+//   (for stepped parameters, this is when the value stays in the same step)
+// Nothing is remembered across blocks: the receiver may have changed the value
+// meanwhile, by a state load or by a gesture, so the first point is kept.
+class ct_automation_coalescer {
+public:
+    void configure(const clap_param_info *info) noexcept;
+    bool has_pending() const noexcept { return m_have_pending; }
+
+    // add a point, in order of offset
+    template <class Emit> void push(int32_t offset, double value, Emit &&emit);
+    // terminate the current block
+    template <class Emit> void flush(Emit &&emit);
+
+private:
+    bool is_redundant(double value) const noexcept;
+    bool is_collinear(int32_t offset, double value) const noexcept;
+    template <class Emit> void emit_pending(bool last, Emit &&emit);
+
+private:
+    double m_step_epsilon = 0;
+    bool m_stepped = false;
+    bool m_have_last = false;
+    bool m_have_last_offset = false;
+    bool m_have_pending = false;
+    int32_t m_last_offset = 0;
+    int32_t m_pending_offset = 0;
+    double m_last_value = 0;
+    double m_pending_value = 0;
+};
+
+//------------------------------------------------------------------------------
+inline void ct_automation_coalescer::configure(const clap_param_info *info) noexcept
+{
+    *this = ct_automation_coalescer{};
+
+    m_stepped = (info->flags & CLAP_PARAM_IS_STEPPED) != 0;
+
+    // half of a step, in normalized units
+    double range = info->max_value - info->min_value;
+    if (m_stepped && range > 0)
+        m_step_epsilon = 0.5 / range;
+}
+
+template <class Emit> void ct_automation_coalescer::push(int32_t offset, double value, Emit &&emit)
+{
+    if (m_have_pending) {
+        if (offset <= m_pending_offset) {
+            m_pending_value = value;
+            return;
+        }
+        bool flat = is_redundant(m_pending_value) && is_redundant(value);
+        if (flat || (!m_stepped && is_collinear(offset, value))) {
+            m_pending_offset = offset;
+            m_pending_value = value;
+            return;
+        }
+        emit_pending(false, emit);
+    }
+
+    m_pending_offset = offset;
+    m_pending_value = value;
+    m_have_pending = true;
+}
+
+template <class Emit> void ct_automation_coalescer::flush(Emit &&emit)
+{
+    if (m_have_pending)
+        emit_pending(true, emit);
+
+    // the next block has its own timeline, and starts from an unknown value
+    m_have_last = false;
+    m_have_last_offset = false;
+}
+
+template <class Emit> void ct_automation_coalescer::emit_pending(bool last, Emit &&emit)
+{
+    m_have_pending = false;
+
+    // a repeated value may only be dropped if it does not start a ramp,
+    // unless the parameter is stepped
+    if ((last || m_stepped) && is_redundant(m_pending_value))
+        return;
+
+    emit(m_pending_offset, m_pending_value);
+
+    m_have_last = true;
+    m_have_last_offset = true;
+    m_last_offset = m_pending_offset;
+    m_last_value = m_pending_value;
+}
+
+inline bool ct_automation_coalescer::is_redundant(double value) const noexcept
+{
+    if (!m_have_last)
+        return false;
+    if (m_stepped)
+        return std::fabs(value - m_last_value) < m_step_epsilon;
+    return value == m_last_value;
+}
+
+inline bool ct_automation_coalescer::is_collinear(int32_t offset, double value) const noexcept
+{
+    if (!m_have_last_offset || m_pending_offset <= m_last_offset)
+        return false;
+
+    double t = (double)(m_pending_offset - m_last_offset) / (double)(offset - m_last_offset);
+    double expected = m_last_value + t * (value - m_last_value);
+    return std::fabs(m_pending_value - expected) <= ct_automation_ramp_tolerance;
+}
+
+} // namespace ct
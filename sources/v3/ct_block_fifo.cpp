@@ -0,0 +1,86 @@
+#include "ct_block_fifo.hpp"
+#include "ct_defs.hpp"
+
+namespace ct {
+
+void ct_block_fifo::configure(nonstd::span<const ct_clap_port_info> inputs, nonstd::span<const ct_clap_port_info> outputs, uint32_t block_size, bool is_64bit)
+{
+    clear();
+
+    m_block_size = block_size;
+    m_is_64bit = is_64bit;
+
+    // channels are aligned for vectors
+    size_t sample_bytes = is_64bit ? sizeof(double) : sizeof(float);
+    m_channel_stride = (block_size * sample_bytes + (ct_buffer_alignment - 1)) & ~(ct_buffer_alignment - 1);
+
+    uint32_t num_channels = 0;
+    for (const ct_clap_port_info &port : inputs)
+        num_channels += port.channel_count;
+    for (const ct_clap_port_info &port : outputs)
+        num_channels += port.channel_count;
+
+    m_samples.allocate(num_channels * m_channel_stride, ct_buffer_alignment, ct_buffer_memory_flags);
+    m_channels.resize(num_channels);
+
+    uint32_t slot = 0;
+    for (bool is_input : {true, false}) {
+        nonstd::span<const ct_clap_port_info> ports = is_input ? inputs : outputs;
+        std::vector<v3_audio_bus_buffers> &buses = is_input ? m_inputs : m_outputs;
+        buses.resize(ports.size());
+        for (uint32_t p_idx = 0; p_idx < (uint32_t)ports.size(); ++p_idx) {
+            v3_audio_bus_buffers &bus = buses[p_idx];
+            bus.num_channels = (int32_t)ports[p_idx].channel_count;
+            bus.channel_silence_bitset = 0;
+            bus.channel_buffers_32 = (float **)&m_channels[slot];
+            for (uint32_t c_idx = 0; c_idx < ports[p_idx].channel_count; ++c_idx, ++slot)
+                m_channels[slot] = m_samples.data() + slot * m_channel_stride;
+        }
+    }
+
+    reset();
+}
+
+void ct_block_fifo::clear()
+{
+    m_block_size = 0;
+    m_position = 0;
+    m_is_64bit = false;
+    m_channel_stride = 0;
+    m_inputs.clear();
+    m_outputs.clear();
+    m_channels.clear();
+    m_samples.reset();
+}
+
+void ct_block_fifo::reset() noexcept
+{
+    if (m_samples)
+        std::memset(m_samples.data(), 0, m_samples.size());
+    m_position = 0;
+}
+
+v3_process_data *ct_block_fifo::block_data(const v3_process_data *host) noexcept
+{
+    v3_process_data &data = m_data;
+    data.process_mode = host->process_mode;
+    data.symbolic_sample_size = host->symbolic_sample_size;
+    data.nframes = (int32_t)m_block_size;
+    data.num_input_buses = (int32_t)m_inputs.size();
+    data.num_output_buses = (int32_t)m_outputs.size();
+    data.inputs = m_inputs.data();
+    data.outputs = m_outputs.data();
+    data.input_params = nullptr;
+    data.output_params = nullptr;
+    data.input_events = nullptr;
+    data.output_events = nullptr;
+    data.ctx = host->ctx;
+
+    // the silence of the inputs is unknown
+    for (v3_audio_bus_buffers &bus : m_inputs)
+        bus.channel_silence_bitset = 0;
+
+    return &data;
+}
+
+} // namespace ct
@@ -0,0 +1,90 @@
+#pragma once
+#include "clap_helpers.hpp"
+#include "travesty_helpers.hpp"
+#include "utility/ct_rt_memory.hpp"
+#include "libs/span.hpp"
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+
+namespace ct {
+
+// Re-blocks the audio of the host to a fixed size, for plugins which process
+// more efficiently with constant blocks, such as FFT-based ones.
+// The host buffers are exchanged with FIFOs at the current position; once the
+// FIFOs are full, the block is processed in place, to be played back during
+// the next block. This adds a latency of one block.
+class ct_block_fifo {
+public:
+    // NOTE: not thread-safe, must not be called while processing
+    void configure(nonstd::span<const ct_clap_port_info> inputs, nonstd::span<const ct_clap_port_info> outputs, uint32_t block_size, bool is_64bit);
+    void clear();
+    bool enabled() const noexcept { return m_block_size != 0; }
+    bool is_64bit() const noexcept { return m_is_64bit; }
+    uint32_t block_size() const noexcept { return m_block_size; }
+    uint32_t position() const noexcept { return m_position; }
+    size_t memory_size() const noexcept { return m_samples.size(); }
+
+    // [audio-thread] fill the buffers with silence, and restart the block
+    void reset() noexcept;
+
+    // [audio-thread] exchange samples with the host, at the current position
+    // returns true when the block is complete, and needs processing
+    // NOTE: the frames must not exceed the rest of the block
+    template <class Real> bool exchange(v3_process_data *data, uint32_t offset, uint32_t nframes) noexcept;
+
+    // [audio-thread] the FIFO buffers as host data, for processing the block
+    v3_process_data *block_data(const v3_process_data *host) noexcept;
+
+private:
+    uint32_t m_block_size = 0;
+    uint32_t m_position = 0;
+    bool m_is_64bit = false;
+    size_t m_channel_stride = 0;
+    std::vector<v3_audio_bus_buffers> m_inputs;
+    std::vector<v3_audio_bus_buffers> m_outputs;
+    std::vector<void *> m_channels;
+    rt_memory m_samples;
+    v3_process_data m_data{};
+};
+
+//------------------------------------------------------------------------------
+template <class Real> bool ct_block_fifo::exchange(v3_process_data *data, uint32_t offset, uint32_t nframes) noexcept
+{
+    uint32_t pos = m_position;
+
+    uint32_t num_inputs = std::min((uint32_t)std::max(data->num_input_buses, 0), (uint32_t)m_inputs.size());
+    for (uint32_t b_idx = 0; b_idx < num_inputs; ++b_idx) {
+        const v3_audio_bus_buffers &bus = data->inputs[b_idx];
+        Real **src = v3_buffer_ptrs<Real>(bus);
+        Real **dst = v3_buffer_ptrs<Real>(m_inputs[b_idx]);
+        uint32_t num_channels = (uint32_t)m_inputs[b_idx].num_channels;
+        for (uint32_t c_idx = 0; c_idx < num_channels; ++c_idx) {
+            const Real *s = (src && (int32_t)c_idx < bus.num_channels) ? src[c_idx] : nullptr;
+            if (s)
+                std::memcpy(dst[c_idx] + pos, s + offset, nframes * sizeof(Real));
+            else
+                std::memset(dst[c_idx] + pos, 0, nframes * sizeof(Real));
+        }
+    }
+
+    uint32_t num_outputs = std::min((uint32_t)std::max(data->num_output_buses, 0), (uint32_t)m_outputs.size());
+    for (uint32_t b_idx = 0; b_idx < num_outputs; ++b_idx) {
+        const v3_audio_bus_buffers &bus = data->outputs[b_idx];
+        Real **src = v3_buffer_ptrs<Real>(m_outputs[b_idx]);
+        Real **dst = v3_buffer_ptrs<Real>(bus);
+        uint32_t num_channels = std::min((uint32_t)std::max(bus.num_channels, 0), (uint32_t)m_outputs[b_idx].num_channels);
+        for (uint32_t c_idx = 0; dst && c_idx < num_channels; ++c_idx) {
+            if (Real *d = dst[c_idx])
+                std::memcpy(d + offset, src[c_idx] + pos, nframes * sizeof(Real));
+        }
+    }
+
+    pos += nframes;
+    bool complete = pos >= m_block_size;
+    m_position = complete ? 0 : pos;
+    return complete;
+}
+
+} // namespace ct
@@ -0,0 +1,50 @@
+#include "ct_bypass.hpp"
+#include "ct_defs.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace ct {
+
+void ct_bypass_engine::configure(clap_id param_id, bool bypassed, uint32_t num_routes, uint32_t latency, uint32_t max_frames, double sample_rate)
+{
+    clear();
+
+    m_param_id = param_id;
+    m_num_routes = num_routes;
+    m_latency = latency;
+    m_max_frames = max_frames;
+    m_ring_size = latency + max_frames;
+
+    m_gain = bypassed ? 0.0 : 1.0;
+    m_target = m_gain;
+
+    uint32_t fade_frames = (uint32_t)std::lround(ct_bypass_crossfade_time * sample_rate);
+    m_step = 1.0 / (double)std::max(fade_frames, 1u);
+
+    size_t ring_length = (size_t)num_routes * m_ring_size;
+    size_t dry_length = (size_t)num_routes * max_frames;
+    size_t ring_bytes = (ring_length * sizeof(double) + (ct_buffer_alignment - 1)) & ~(ct_buffer_alignment - 1);
+    m_memory.allocate(ring_bytes + dry_length * sizeof(double), ct_buffer_alignment, ct_buffer_memory_flags);
+    m_rings = (double *)m_memory.data();
+    m_dry = (double *)(m_memory.data() + ring_bytes);
+}
+
+void ct_bypass_engine::clear()
+{
+    *this = ct_bypass_engine{};
+}
+
+void ct_bypass_engine::advance(uint32_t nframes) noexcept
+{
+    if (m_ring_size == 0)
+        return;
+
+    if (m_gain != m_target) {
+        double delta = m_step * nframes;
+        m_gain = (m_target > m_gain) ? std::min(m_gain + delta, m_target) : std::max(m_gain - delta, m_target);
+    }
+
+    m_write_pos = (m_write_pos + nframes) % m_ring_size;
+}
+
+} // namespace ct
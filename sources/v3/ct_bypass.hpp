@@ -0,0 +1,97 @@
+#pragma once
+#include <clap/clap.h>
+#include "utility/ct_rt_memory.hpp"
+#include <algorithm>
+#include <cstdint>
+
+namespace ct {
+
+// Bypasses the plugin in the wrapper, when the host sets the bypass parameter.
+// The plugin fades out and stops being processed, and each output receives
+// the input of same bus and channel, delayed by the latency of the plugin.
+// The dry inputs are captured continuously, so the delay line is always
+// ready when the bypass engages.
+class ct_bypass_engine {
+public:
+    // NOTE: not thread-safe, must not be called while processing
+    void configure(clap_id param_id, bool bypassed, uint32_t num_routes, uint32_t latency, uint32_t max_frames, double sample_rate);
+    void clear();
+    bool enabled() const noexcept { return m_param_id != CLAP_INVALID_ID; }
+    clap_id param_id() const noexcept { return m_param_id; }
+
+    // [audio-thread]
+    void set_bypassed(bool bypassed) noexcept { m_target = bypassed ? 0.0 : 1.0; }
+    // whether the plugin is completely bypassed, and need not run
+    bool is_bypassed() const noexcept { return m_gain == 0.0 && m_target == 0.0; }
+    // whether the plugin is completely active, and its output is unaltered
+    bool is_transparent() const noexcept { return m_gain == 1.0 && m_target == 1.0; }
+
+    // [audio-thread] feed the input of the route, or silence if null,
+    // and extract the delayed dry signal for the current block
+    template <class Real> void capture(uint32_t route_index, const Real *input, uint32_t nframes) noexcept;
+    // [audio-thread] crossfade the output of the route with the dry signal
+    template <class Real> void mix(uint32_t route_index, Real *output, uint32_t nframes) const noexcept;
+    // [audio-thread] terminate the current block
+    void advance(uint32_t nframes) noexcept;
+
+private:
+    double *ring(uint32_t route_index) const noexcept { return m_rings + route_index * m_ring_size; }
+    double *dry(uint32_t route_index) const noexcept { return m_dry + route_index * m_max_frames; }
+
+private:
+    clap_id m_param_id = CLAP_INVALID_ID;
+    uint32_t m_num_routes = 0;
+    uint32_t m_latency = 0;
+    uint32_t m_max_frames = 0;
+    uint32_t m_ring_size = 0;
+    uint32_t m_write_pos = 0;
+    double m_gain = 1.0; // gain of the plugin output, the dry gain is complementary
+    double m_target = 1.0;
+    double m_step = 1.0;
+    double *m_rings = nullptr;
+    double *m_dry = nullptr;
+    rt_memory m_memory;
+};
+
+//------------------------------------------------------------------------------
+template <class Real> void ct_bypass_engine::capture(uint32_t route_index, const Real *input, uint32_t nframes) noexcept
+{
+    if (route_index >= m_num_routes || nframes > m_max_frames)
+        return;
+
+    double *rb = ring(route_index);
+    uint32_t size = m_ring_size;
+
+    uint32_t wp = m_write_pos;
+    for (uint32_t i = 0; i < nframes; ++i) {
+        rb[wp] = input ? (double)input[i] : 0.0;
+        wp = (wp + 1 == size) ? 0 : (wp + 1);
+    }
+
+    double *out = dry(route_index);
+    uint32_t rp = (m_write_pos + size - m_latency) % size;
+    for (uint32_t i = 0; i < nframes; ++i) {
+        out[i] = rb[rp];
+        rp = (rp + 1 == size) ? 0 : (rp + 1);
+    }
+}
+
+template <class Real> void ct_bypass_engine::mix(uint32_t route_index, Real *output, uint32_t nframes) const noexcept
+{
+    if (route_index >= m_num_routes || nframes > m_max_frames)
+        return;
+
+    const double *in = dry(route_index);
+    double gain = m_gain;
+    double step = (m_target > m_gain) ? m_step : -m_step;
+
+    for (uint32_t i = 0; i < nframes; ++i) {
+        if (gain != m_target)
+            gain = (step > 0) ? std::min(gain + step, m_target) : std::max(gain + step, m_target);
+        // the output is not read when bypassed, it may be uninitialized
+        output[i] = (gain == 0.0) ? (Real)in[i] :
+            (Real)(gain * (double)output[i] + (1.0 - gain) * in[i]);
+    }
+}
+
+} // namespace ct
@@ -15,21 +15,33 @@
 #include "ct_event_conversion.hpp"
 #include "ct_component_caches.hpp"
 #include "ct_threads.hpp"
+#include "ct_thread_pool.hpp"
+#include "ct_live_stats.hpp"
 #include "clap_helpers.hpp"
+#include "utility/ct_audio_kernels.hpp"
 #include "utility/unicode_helpers.hpp"
 #include "utility/ct_messages.hpp"
 #include "utility/ct_scope.hpp"
 #include "libs/span.hpp"
+#include <algorithm>
 #include <cstring>
 
 namespace ct {
 
 const ct_component::vtable ct_component::s_vtable;
 
+#if CT_LIVE_STATS
+static void publish_memory_size(ct_component *self);
+#endif
+
 ct_component::ct_component(const v3_tuid clsiid, const clap_plugin_factory *factory, const clap_plugin_descriptor *desc, v3::object *hostcontext, bool *init_ok)
 {
     *init_ok = false;
 
+    // the host creates the components on its main thread, or on any thread
+    // which it uses as such for the time of the call
+    ct_thread_role_scope role{ct_thread_role_main};
+
     std::memcpy(m_clsiid, clsiid, sizeof(v3_tuid));
 
     ct_host *host = new ct_host{hostcontext};
@@ -65,6 +77,8 @@ ct_component::ct_component(const v3_tuid clsiid, const clap_plugin_factory *fact
     m_transport.header.type = CLAP_EVENT_TRANSPORT;
     m_input_events.reset(new ct_events_buffer{ct_events_buffer_capacity});
     m_output_events.reset(new ct_events_buffer{ct_events_buffer_capacity});
+    m_block_events.reset(new ct_events_buffer{ct_events_buffer_capacity});
+    m_delayed_events.reset(new ct_events_buffer{ct_events_buffer_capacity});
 
     // extensions
     const clap_plugin_audio_ports *audio_ports = (const clap_plugin_audio_ports *)CLAP_CALL(plug, get_extension, plug, CLAP_EXT_AUDIO_PORTS);
@@ -75,6 +89,11 @@ ct_component::ct_component(const v3_tuid clsiid, const clap_plugin_factory *fact
     const clap_plugin_audio_ports_config *audio_ports_config = (const clap_plugin_audio_ports_config *)CLAP_CALL(plug, get_extension, plug, CLAP_EXT_AUDIO_PORTS_CONFIG);
     m_ext.m_audio_ports_config = audio_ports_config;
 
+    const ct_clap_plugin_audio_ports_activation *audio_ports_activation = (const ct_clap_plugin_audio_ports_activation *)CLAP_CALL(plug, get_extension, plug, ct_clap_ext_audio_ports_activation);
+    if (!audio_ports_activation)
+        audio_ports_activation = (const ct_clap_plugin_audio_ports_activation *)CLAP_CALL(plug, get_extension, plug, ct_clap_ext_audio_ports_activation_compat);
+    m_ext.m_audio_ports_activation = audio_ports_activation;
+
     const clap_plugin_surround *surround = (const clap_plugin_surround *)CLAP_CALL(plug, get_extension, plug, CLAP_EXT_SURROUND);
     m_ext.m_surround = surround;
 
@@ -96,6 +115,11 @@ ct_component::ct_component(const v3_tuid clsiid, const clap_plugin_factory *fact
     const clap_plugin_timer_support *timer_support = (const clap_plugin_timer_support *)CLAP_CALL(plug, get_extension, plug, CLAP_EXT_TIMER_SUPPORT);
     m_ext.m_timer_support = timer_support;
 
+#if CT_HOST_THREAD_POOL
+    const clap_plugin_thread_pool *thread_pool = (const clap_plugin_thread_pool *)CLAP_CALL(plug, get_extension, plug, CLAP_EXT_THREAD_POOL);
+    m_ext.m_thread_pool = thread_pool;
+#endif
+
 #if CT_X11
     const clap_plugin_posix_fd_support *posix_fd_support = (const clap_plugin_posix_fd_support *)CLAP_CALL(plug, get_extension, plug, CLAP_EXT_POSIX_FD_SUPPORT);
     m_ext.m_posix_fd_support = posix_fd_support;
@@ -111,12 +135,24 @@ ct_component::ct_component(const v3_tuid clsiid, const clap_plugin_factory *fact
     cache->on_cache_update = &on_cache_update;
     cache->update_caches_now();
 
+#if CT_LIVE_STATS
+    m_stats = ct_live_stats::instance().claim(desc->name);
+    publish_memory_size(this);
+#endif
+
     //
     *init_ok = true;
 }
 
 ct_component::~ct_component()
 {
+    ct_thread_role_scope role{ct_thread_role_main};
+
+#if CT_LIVE_STATS
+    if (m_stats)
+        ct_live_stats::instance().release(m_stats);
+#endif
+
     if (const clap_plugin *plug = m_plug)
         CLAP_CALL(plug, destroy, plug);
 }
@@ -128,6 +164,12 @@ void ct_component::on_reserved_timer(clap_id timer_id)
     if (m_have_idle_timer && m_idle_timer_id == timer_id) {
         if (m_flag_sched_plugin_callback.exchange(0, std::memory_order_relaxed))
             CLAP_CALL(plug, on_main_thread, plug);
+
+        // update the controller with the values from the processor
+        m_param_feedback.collect([this](uint32_t index, double value) {
+            if (index < m_param_value_cache.size())
+                m_param_value_cache[index] = value;
+        });
     }
 }
 
@@ -135,6 +177,24 @@ void ct_component::on_cache_update(void *self_, uint32_t flags)
 {
     ct_component *self = (ct_component *)self_;
 
+    if (flags & ct_caches::cache_flags_audio_ports) {
+        // the ports only change while inactive, and the activation allocates
+        // the process plan for them
+        CT_ASSERT(!self->m_active);
+
+        // the buses of the plugin are active after the update, and the
+        // activation forwards the ones which the host has disabled;
+        // all buses are active by default, so the flags of the host reset
+        // only if the buses are not the same
+        const ct_caches::ports_t *audio_ports = self->m_cache->get_audio_ports();
+        if (self->m_active_inputs.size() != audio_ports->m_inputs.size())
+            self->m_active_inputs.assign(audio_ports->m_inputs.size(), true);
+        if (self->m_active_outputs.size() != audio_ports->m_outputs.size())
+            self->m_active_outputs.assign(audio_ports->m_outputs.size(), true);
+        self->m_plugin_active_inputs.assign(audio_ports->m_inputs.size(), true);
+        self->m_plugin_active_outputs.assign(audio_ports->m_outputs.size(), true);
+    }
+
     if (flags & ct_caches::cache_flags_params)
         self->sync_parameter_values_to_controller_from_plugin();
 }
@@ -147,6 +207,8 @@ void ct_component::sync_parameter_values_to_controller_from_plugin()
 
     uint32_t count = (uint32_t)cache->m_params.size();
     m_param_value_cache.resize(count);
+    if (m_param_feedback.size() != count)
+        m_param_feedback.resize(count);
 
     for (uint32_t i = 0; i < count; ++i) {
         const clap_param_info &info = cache->m_params[i];
@@ -228,6 +290,8 @@ v3_result V3_API ct_component::initialize(void *self_, v3_funknown **context_)
 {
     LOG_PLUGIN_SELF_CALL(self_);
 
+    ct_thread_role_scope role{ct_thread_role_main};
+
     ct_component *self = (ct_component *)self_;
     v3::object *context = (v3::object *)context_;
 
@@ -259,6 +323,8 @@ v3_result V3_API ct_component::terminate(void *self_)
 {
     LOG_PLUGIN_SELF_CALL(self_);
 
+    ct_thread_role_scope role{ct_thread_role_main};
+
     ct_component *self = (ct_component *)self_;
 
     if (!self->m_initialized)
@@ -399,8 +465,10 @@ v3_result V3_API ct_component::activate_bus(void *self_, int32_t media_type, int
         if ((uint32_t)bus_idx >= ports.size())
             LOG_PLUGIN_RET(V3_FALSE);
 
-        // nothing to do
-        (void)state;
+        // takes effect at the next activation of the plugin
+        std::vector<uint8_t> &active = (bus_direction == V3_INPUT) ? self->m_active_inputs : self->m_active_outputs;
+        if ((uint32_t)bus_idx < active.size())
+            active[(uint32_t)bus_idx] = (bool)state;
         LOG_PLUGIN_RET(V3_OK);
     }
     else if (media_type == V3_EVENT) {
@@ -416,51 +484,206 @@ v3_result V3_API ct_component::activate_bus(void *self_, int32_t media_type, int
     }
 }
 
+// the maximum frames which the plugin processes at once
+static uint32_t get_plugin_max_frames(ct_component *self)
+{
+    if (CT_FIXED_BLOCK_SIZE > 0)
+        return CT_FIXED_BLOCK_SIZE;
+    return (uint32_t)self->m_setup.max_block_size;
+}
+
 static void allocate_buffers(ct_component *self, size_t buffer_size)
 {
     const ct_caches::ports_t *audio_ports = self->m_cache->get_audio_ports();
 
-    // calculate the required amount of pointer-bump memory
-    size_t dynamic_capacity = 0;
-    bool can_do_64bit = audio_ports->m_can_do_64bit;
-    size_t float_size = can_do_64bit ? sizeof(double) : sizeof(float);
-
-    auto pad_size = [](size_t size) -> size_t {
-        constexpr size_t align = alignof(std::max_align_t);
-        return (size + (align - 1)) & ~(align - 1);
-    };
-
-    for (bool is_input : {false, true}) {
-        const std::vector<ct_clap_port_info> &ports = audio_ports->get_port_list(is_input);
-        uint32_t num_ports = (uint32_t)ports.size();
-
-        // the array of I/O structures
-        dynamic_capacity += pad_size(num_ports * sizeof(clap_audio_buffer));
-
-        for (uint32_t p_idx = 0; p_idx < num_ports; ++p_idx) {
-            const ct_clap_port_info &port = ports[p_idx];
-            // the channel buffer
-            if (is_input)
-                dynamic_capacity += port.channel_count * pad_size(buffer_size * float_size);
-            // the array of buffer pointers
-            dynamic_capacity += pad_size(port.channel_count * sizeof(void *));
+    // the plugin runs in the precision of the host, if it's able to
+    bool host_64bit = self->m_setup.symbolic_sample_size == V3_SAMPLE_64;
+    bool plugin_64bit = host_64bit && audio_ports->m_can_do_64bit;
+
+    // allocate, leaving out the inactive buses
+    ct_process_plan::port_list inputs{audio_ports->m_inputs, self->m_active_inputs};
+    ct_process_plan::port_list outputs{audio_ports->m_outputs, self->m_active_outputs};
+    self->m_plan.build(inputs, outputs, (uint32_t)buffer_size, host_64bit, plugin_64bit);
+
+    // the specialized path, if the plugin has a fixed layout and it matches
+    self->m_fixed_kernel = ct_audio_processor::select_fixed_kernel(self, host_64bit);
+
+    // the FIFOs, in the precision of the host
+    if (CT_FIXED_BLOCK_SIZE > 0)
+        self->m_fifo.configure(audio_ports->m_inputs, audio_ports->m_outputs, CT_FIXED_BLOCK_SIZE, host_64bit);
+
+#if CT_SILENCE_STATISTICS
+    self->m_input_silence_stats.assign(self->m_plan.inputs().m_routes.size(), ct_silence_statistics{});
+    self->m_output_silence_stats.assign(self->m_plan.outputs().m_routes.size(), ct_silence_statistics{});
+#endif
+#if CT_OUTPUT_SANITIZER
+    self->m_sanitizer_stats = ct_sanitizer_statistics{};
+#endif
+}
+
+#if CT_SILENCE_STATISTICS
+static void report_silence_statistics(ct_component *self)
+{
+    CT_MESSAGE("Silence statistics (", audio_kernels_isa(), ")");
+    for (bool is_input : {true, false}) {
+        const std::vector<ct_silence_statistics> &stats = is_input ?
+            self->m_input_silence_stats : self->m_output_silence_stats;
+        for (uint32_t i = 0; i < (uint32_t)stats.size(); ++i) {
+            CT_MESSAGE_NP(CT_MESSAGE_PREFIX_SPACES,
+                          is_input ? "Input " : "Output ", i, ": ",
+                          stats[i].m_flagged, "/", stats[i].m_blocks,
+                          is_input ? " blocks constant" : " blocks silent");
+        }
+    }
+}
+#endif
+
+#if CT_OUTPUT_SANITIZER
+static void report_sanitizer_statistics(ct_component *self)
+{
+    const ct_sanitizer_statistics &stats = self->m_sanitizer_stats;
+    if (stats.m_non_finite > 0)
+        CT_WARNING("The plugin has output infinity or NaN, muted ", stats.m_non_finite, " channel blocks");
+    if (stats.m_subnormal > 0)
+        CT_MESSAGE("The plugin has output subnormals, flushed ", stats.m_subnormal, " channel blocks");
+}
+#endif
+
+#if CT_PROCESS_TIMING
+static void report_process_timing(ct_component *self)
+{
+    ct_process_timing_snapshot timing;
+    self->m_timing.snapshot(timing);
+    if (timing.m_over_threshold == 0)
+        return;
+
+    uint64_t blocks = std::max(timing.m_blocks, uint64_t{1});
+    CT_WARNING("The processing has come close to the deadline in ", timing.m_over_threshold, "/", timing.m_blocks, " blocks, and missed it in ", timing.m_over_budget);
+    CT_MESSAGE_NP(CT_MESSAGE_PREFIX_SPACES, "Highest load: ", (int)(timing.m_max_load * 100), "% of the budget");
+    CT_MESSAGE_NP(CT_MESSAGE_PREFIX_SPACES, "Plugin: ", timing.m_plugin.m_total_ns / blocks, " ns average, ", timing.m_plugin.m_max_ns, " ns max");
+    CT_MESSAGE_NP(CT_MESSAGE_PREFIX_SPACES, "Wrapper: ", timing.m_wrapper.m_total_ns / blocks, " ns average, ", timing.m_wrapper.m_max_ns, " ns max");
+    if (timing.m_offline_blocks > 0) {
+        CT_MESSAGE_NP(CT_MESSAGE_PREFIX_SPACES, "Offline: ", timing.m_offline_blocks, " blocks, without deadline");
+    }
+}
+#endif
+
+#if CT_LIVE_STATS
+// the buffers which belong to the instance, excluding those shared
+static void publish_memory_size(ct_component *self)
+{
+    ct_live_stats_slot *stats = self->m_stats;
+    if (!stats)
+        return;
+
+    size_t size = self->m_plan.memory_size() + self->m_fifo.memory_size();
+    for (const ct_events_buffer *buffer : {self->m_input_events.get(), self->m_output_events.get(), self->m_block_events.get(), self->m_delayed_events.get()})
+        size += buffer->memory_size();
+    stats->m_memory_bytes.store(size, std::memory_order_relaxed);
+}
+
+static void publish_activation(ct_component *self, bool active)
+{
+    ct_live_stats_slot *stats = self->m_stats;
+    if (!stats)
+        return;
+
+    stats->m_sample_rate.store(active ? (uint32_t)self->m_setup.sample_rate : 0, std::memory_order_relaxed);
+    stats->m_active.store(active, std::memory_order_relaxed);
+    publish_memory_size(self);
+}
+#endif
+
+static uint32_t get_events_buffer_capacity(const ct_events_buffer *buffer, uint32_t param_count)
+{
+    // enough for a change of every parameter, or twice the peak load observed
+    size_t capacity = ct_events_buffer_capacity;
+    capacity = std::max(capacity, param_count * sizeof(clap_event_param_value));
+    capacity = std::max(capacity, 2 * (size_t)buffer->get_statistics().m_high_water_bytes);
+    return (uint32_t)std::min(capacity, (size_t)ct_events_buffer_max_capacity);
+}
+
+static void configure_events_buffers(ct_component *self)
+{
+    uint32_t param_count = (uint32_t)self->m_cache->get_params()->m_params.size();
+
+    for (ct_events_buffer *buffer : {self->m_input_events.get(), self->m_output_events.get(), self->m_block_events.get(), self->m_delayed_events.get()}) {
+        uint32_t capacity = get_events_buffer_capacity(buffer, param_count);
+        if (capacity != buffer->capacity())
+            buffer->reconfigure(capacity);
+    }
+}
+
+static void report_events_buffers(ct_component *self)
+{
+    for (bool is_input : {true, false}) {
+        const ct_events_buffer *buffer = is_input ? self->m_input_events.get() : self->m_output_events.get();
+        ct_events_buffer::statistics st = buffer->get_statistics();
+        if (st.m_dropped > 0) {
+            CT_WARNING("Dropped ", st.m_dropped, is_input ? " input" : " output",
+                       " events, with a peak of ", st.m_high_water_bytes, " bytes per block");
+        }
+    }
+}
+
+#if CT_WRAPPER_BYPASS
+static void configure_bypass(ct_component *self)
+{
+    const clap_plugin *plug = self->m_plug;
+    const clap_plugin_params *params = self->m_ext.m_params;
+    const clap_plugin_latency *latency = self->m_ext.m_latency;
+
+    self->m_bypass.clear();
+    self->m_bypass_skipped = false;
+
+    const clap_param_info *bypass_info = nullptr;
+    for (const clap_param_info &info : self->m_cache->get_params()->m_params) {
+        if (info.flags & CLAP_PARAM_IS_BYPASS) {
+            bypass_info = &info;
+            break;
         }
     }
+    if (!params || !bypass_info)
+        return;
 
-    // allocate
-    self->m_dynamic_capacity = dynamic_capacity;
-    self->m_dynamic_buffers = stdc_allocate<uint8_t>(dynamic_capacity);
-    self->m_zero_buffer = stdc_allocate<uint8_t>(buffer_size * float_size);
-    self->m_trash_buffer = stdc_allocate<uint8_t>(buffer_size * float_size);
+    double value = 0;
+    bool bypassed = CLAP_CALL(params, get_value, plug, bypass_info->id, &value) && value >= 0.5;
+    uint32_t latency_samples = latency ? CLAP_CALL(latency, get, plug) : 0;
+
+    const v3_process_setup &setup = self->m_setup;
+    uint32_t num_routes = (uint32_t)self->m_plan.outputs().m_routes.size();
+    self->m_bypass.configure(bypass_info->id, bypassed, num_routes, latency_samples, self->m_plan.max_frames(), setup.sample_rate);
 }
+#endif
 
 static void deallocate_buffers(ct_component *self)
 {
-    self->m_dynamic_buffers.reset();
-    self->m_dynamic_capacity = 0;
+    self->m_plan.clear();
+    self->m_fixed_kernel = nullptr;
+    self->m_fifo.clear();
+}
+
+static void forward_bus_activation(ct_component *self)
+{
+    const clap_plugin *plug = self->m_plug;
+    const ct_clap_plugin_audio_ports_activation *activation = self->m_ext.m_audio_ports_activation;
+    if (!activation)
+        return;
 
-    self->m_zero_buffer.reset();
-    self->m_trash_buffer.reset();
+    const ct_caches::ports_t *audio_ports = self->m_cache->get_audio_ports();
+    bool host_64bit = self->m_setup.symbolic_sample_size == V3_SAMPLE_64;
+    uint32_t sample_size = (host_64bit && audio_ports->m_can_do_64bit) ? 64 : 32;
+
+    for (bool is_input : {true, false}) {
+        const std::vector<uint8_t> &active = is_input ? self->m_active_inputs : self->m_active_outputs;
+        std::vector<uint8_t> &plugin_active = is_input ? self->m_plugin_active_inputs : self->m_plugin_active_outputs;
+        for (uint32_t p_idx = 0; p_idx < (uint32_t)active.size(); ++p_idx) {
+            if (active[p_idx] == plugin_active[p_idx])
+                continue;
+            if (CLAP_CALL(activation, set_active, plug, is_input, p_idx, active[p_idx], sample_size))
+                plugin_active[p_idx] = active[p_idx];
+        }
+    }
 }
 
 v3_result V3_API ct_component::set_active(void *self_, v3_bool state)
@@ -476,23 +699,67 @@ v3_result V3_API ct_component::set_active(void *self_, v3_bool state)
 
     const clap_plugin *plug = self->m_plug;
     if (state) {
+        forward_bus_activation(self);
+        //
         v3_process_setup setup = self->m_setup;
-        if (!CLAP_CALL(plug, activate, plug, setup.sample_rate, 1, (uint32_t)setup.max_block_size))
+        uint32_t max_frames = get_plugin_max_frames(self);
+        uint32_t min_frames = (CT_FIXED_BLOCK_SIZE > 0) ? max_frames : 1;
+        if (!CLAP_CALL(plug, activate, plug, setup.sample_rate, min_frames, max_frames))
             LOG_PLUGIN_RET(V3_FALSE);
         //
-        allocate_buffers(self, (uint32_t)setup.max_block_size);
+        allocate_buffers(self, max_frames);
+        configure_events_buffers(self);
+#if CT_WRAPPER_BYPASS
+        configure_bypass(self);
+#endif
+#if CT_HOST_THREAD_POOL
+        if (self->m_ext.m_thread_pool)
+            ct_thread_pool::instance().attach();
+#endif
+#if CT_PROCESS_TIMING
+        self->m_timing.configure(setup.sample_rate);
+#endif
         self->m_event_converter_in.reset(new event_converter_v3_to_clap(self));
         self->m_event_converter_out.reset(new event_converter_clap_to_v3(self));
         //
         self->m_active = true;
+#if CT_LIVE_STATS
+        publish_activation(self, true);
+#endif
     }
     else {
+#if CT_SILENCE_STATISTICS
+        report_silence_statistics(self);
+#endif
+#if CT_OUTPUT_SANITIZER
+        report_sanitizer_statistics(self);
+#endif
+#if CT_RT_AUDIT
+        rt_audit::report();
+#endif
+#if CT_PROCESS_TIMING
+        report_process_timing(self);
+#endif
+#if CT_FOOTPRINT_STATISTICS
+        ct_shared_buffers::instance().report_footprint();
+#endif
+        report_events_buffers(self);
         deallocate_buffers(self);
+#if CT_WRAPPER_BYPASS
+        self->m_bypass.clear();
+#endif
         self->m_event_converter_in.reset();
         self->m_event_converter_out.reset();
         //
         CLAP_CALL(plug, deactivate, plug);
         self->m_active = false;
+#if CT_LIVE_STATS
+        publish_activation(self, false);
+#endif
+#if CT_HOST_THREAD_POOL
+        if (self->m_ext.m_thread_pool)
+            ct_thread_pool::instance().detach();
+#endif
     }
 
     LOG_PLUGIN_RET(V3_OK);
@@ -502,6 +769,8 @@ v3_result V3_API ct_component::set_state(void *self_, v3_bstream **stream_)
 {
     LOG_PLUGIN_SELF_CALL(self_);
 
+    ct_thread_role_scope role{ct_thread_role_main};
+
     ct_component *self = (ct_component *)self_;
     const clap_plugin_state *state = self->m_ext.m_state;
 
@@ -519,6 +788,8 @@ v3_result V3_API ct_component::get_state(void *self_, v3_bstream **stream_)
 {
     LOG_PLUGIN_SELF_CALL(self_);
 
+    ct_thread_role_scope role{ct_thread_role_main};
+
     ct_component *self = (ct_component *)self_;
     const clap_plugin_state *state = self->m_ext.m_state;
 
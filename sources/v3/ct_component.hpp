@@ -1,6 +1,12 @@
 #pragma once
 #include "ct_defs.hpp"
 #include "travesty_helpers.hpp"
+#include "ct_process_plan.hpp"
+#include "ct_param_feedback.hpp"
+#include "ct_bypass.hpp"
+#include "ct_block_fifo.hpp"
+#include "ct_sleep_state.hpp"
+#include "ct_process_timing.hpp"
 #include "utility/ct_memory.hpp"
 #include <travesty/component.h>
 #include <travesty/audio_processor.h>
@@ -13,6 +19,7 @@
 namespace ct {
 
 struct ct_audio_processor;
+struct ct_process_kernel;
 struct ct_edit_controller;
 struct ct_unit_description;
 struct ct_process_context_requirements;
@@ -21,9 +28,24 @@ struct ct_timer_handler;
 struct ct_host;
 class ct_events_buffer;
 struct ct_caches;
+struct ct_live_stats_slot;
 class event_converter_v3_to_clap;
 class event_converter_clap_to_v3;
 
+#if CT_SILENCE_STATISTICS
+struct ct_silence_statistics {
+    uint64_t m_blocks = 0;
+    uint64_t m_flagged = 0;
+};
+#endif
+
+#if CT_OUTPUT_SANITIZER
+struct ct_sanitizer_statistics {
+    uint64_t m_non_finite = 0; // channel blocks muted
+    uint64_t m_subnormal = 0; // channel blocks with subnormals flushed
+};
+#endif
+
 struct ct_component {
     ct_component(const v3_tuid clsiid, const clap_plugin_factory *factory, const clap_plugin_descriptor *desc, v3::object *hostcontext, bool *init_ok);
     ~ct_component();
@@ -87,8 +109,6 @@ struct ct_component {
     std::atomic<unsigned> m_refcnt{1};
     bool m_initialized = false;
     bool m_active = false;
-    bool m_should_process = false;
-    enum { stopped, started, errored } m_processing_status = stopped;
     v3::object *m_context = nullptr;
     v3::component_handler *m_handler = nullptr;
     v3::component_handler2 *m_handler2 = nullptr;
@@ -102,15 +122,50 @@ struct ct_component {
 
     // controller
     std::vector<double> m_param_value_cache;
+    ct_param_feedback m_param_feedback; // values output by the processor
 
     // processor
+    // NOTE: the fields used by the audio callback are grouped together,
+    //       starting on a separate cache line
+    alignas(ct_cache_line_size) bool m_should_process = false;
+    enum { stopped, started, errored } m_processing_status = stopped;
     clap_event_transport m_transport{};
+    ct_process_plan m_plan;
+    const ct_process_kernel *m_fixed_kernel = nullptr; // specialized path, if any
     std::unique_ptr<ct_events_buffer> m_input_events;
     std::unique_ptr<ct_events_buffer> m_output_events;
-
-    // events
+    std::unique_ptr<ct_events_buffer> m_block_events; // input events of a part of block
+    std::unique_ptr<ct_events_buffer> m_delayed_events; // output events of a fixed block
+    uint32_t m_delayed_index = 0; // the next delayed event to send
+    int32_t m_delayed_start = 0; // the frame where the delayed block comes out
+    ct_block_fifo m_fifo;
     std::unique_ptr<event_converter_v3_to_clap> m_event_converter_in;
     std::unique_ptr<event_converter_clap_to_v3> m_event_converter_out;
+    ct_sleep_state m_sleep;
+#if CT_WRAPPER_BYPASS
+    ct_bypass_engine m_bypass;
+    bool m_bypass_skipped = false; // the plugin has not run since the bypass
+#endif
+#if CT_SILENCE_STATISTICS
+    // analysis counters, indexed by channel in the order of ports
+    std::vector<ct_silence_statistics> m_input_silence_stats;
+    std::vector<ct_silence_statistics> m_output_silence_stats;
+#endif
+#if CT_OUTPUT_SANITIZER
+    ct_sanitizer_statistics m_sanitizer_stats;
+#endif
+#if CT_PROCESS_TIMING
+    ct_process_timing m_timing;
+#endif
+#if CT_LIVE_STATS
+    ct_live_stats_slot *m_stats = nullptr; // published counters, if any
+#endif
+
+    // audio buses
+    std::vector<uint8_t> m_active_inputs; // activation by the host
+    std::vector<uint8_t> m_active_outputs;
+    std::vector<uint8_t> m_plugin_active_inputs; // activation known by the plugin
+    std::vector<uint8_t> m_plugin_active_outputs;
 
     // editor
     ct_plug_view *m_editor = nullptr;
@@ -121,16 +176,11 @@ struct ct_component {
     // inter-thread interaction
     std::atomic<int> m_flag_sched_plugin_callback{0};
 
-    // temporary buffers
-    stdc_ptr<uint8_t[]> m_dynamic_buffers;
-    size_t m_dynamic_capacity = 0;
-    stdc_ptr<uint8_t[]> m_zero_buffer;
-    stdc_ptr<uint8_t[]> m_trash_buffer;
-
     // extensions
     struct {
         const clap_plugin_audio_ports *m_audio_ports = nullptr; // required
         const clap_plugin_audio_ports_config *m_audio_ports_config = nullptr; // optional
+        const ct_clap_plugin_audio_ports_activation *m_audio_ports_activation = nullptr; // optional
         const clap_plugin_surround *m_surround = nullptr; // optional
         const clap_plugin_state *m_state = nullptr; // optional
         const clap_plugin_latency *m_latency = nullptr; // optional
@@ -138,6 +188,9 @@ struct ct_component {
         const clap_plugin_render *m_render = nullptr; // optional
         const clap_plugin_params *m_params = nullptr; // optional
         const clap_plugin_timer_support *m_timer_support = nullptr; // optional
+#if CT_HOST_THREAD_POOL
+        const clap_plugin_thread_pool *m_thread_pool = nullptr; // optional
+#endif
 #if CT_X11
         const clap_plugin_posix_fd_support *m_posix_fd_support = nullptr; // optional
 #endif
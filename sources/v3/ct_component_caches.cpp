@@ -122,6 +122,42 @@ static void cache_audio_ports_internal(
     }
 }
 
+static void resolve_in_place_pairs(std::vector<ct_clap_port_info> &inputs, std::vector<ct_clap_port_info> &outputs)
+{
+    auto find_port_by_id = [](const std::vector<ct_clap_port_info> &ports, clap_id id) -> uint32_t {
+        for (uint32_t p_idx = 0, n = (uint32_t)ports.size(); p_idx < n; ++p_idx) {
+            if (ports[p_idx].id == id)
+                return p_idx;
+        }
+        return ct_clap_port_info::no_port;
+    };
+
+    for (ct_clap_port_info &port : inputs) {
+        port.in_place_pair_index = ct_clap_port_info::no_port;
+        if (port.in_place_pair != CLAP_INVALID_ID)
+            port.in_place_pair_index = find_port_by_id(outputs, port.in_place_pair);
+    }
+    for (ct_clap_port_info &port : outputs) {
+        port.in_place_pair_index = ct_clap_port_info::no_port;
+        if (port.in_place_pair != CLAP_INVALID_ID)
+            port.in_place_pair_index = find_port_by_id(inputs, port.in_place_pair);
+    }
+
+    // the pairing is only usable if channel layouts are the same on both sides
+    for (ct_clap_port_info &in : inputs) {
+        uint32_t out_idx = in.in_place_pair_index;
+        if (out_idx == ct_clap_port_info::no_port)
+            continue;
+        ct_clap_port_info &out = outputs[out_idx];
+        if (out.in_place_pair_index != (uint32_t)(&in - inputs.data()) ||
+            out.channel_count != in.channel_count)
+        {
+            in.in_place_pair_index = ct_clap_port_info::no_port;
+            out.in_place_pair_index = ct_clap_port_info::no_port;
+        }
+    }
+}
+
 void ct_caches::impl::cache_audio_port_configs()
 {
     if ((m_dirty_flags & cache_flags_audio_ports_config) == 0)
@@ -157,6 +193,7 @@ void ct_caches::impl::cache_audio_port_configs()
         info.m_can_do_64bit = true;
         cache_audio_ports_internal(plug, comp->m_ext.m_audio_ports, comp->m_ext.m_surround, true, info.m_inputs, &info.m_total_channels, &info.m_can_do_64bit);
         cache_audio_ports_internal(plug, comp->m_ext.m_audio_ports, comp->m_ext.m_surround, false, info.m_outputs, &info.m_total_channels, &info.m_can_do_64bit);
+        resolve_in_place_pairs(info.m_inputs, info.m_outputs);
 
         // check the information for consistency
         const uint32_t input_count = info.m_config.input_port_count;
@@ -235,6 +272,7 @@ void ct_caches::impl::cache_audio_ports(bool do_callback)
     audio_ports->m_can_do_64bit = true;
     cache_audio_ports_internal(plug, comp->m_ext.m_audio_ports, comp->m_ext.m_surround, true, audio_ports->m_inputs, &audio_ports->m_total_channels, &audio_ports->m_can_do_64bit);
     cache_audio_ports_internal(plug, comp->m_ext.m_audio_ports, comp->m_ext.m_surround, false, audio_ports->m_outputs, &audio_ports->m_total_channels, &audio_ports->m_can_do_64bit);
+    resolve_in_place_pairs(audio_ports->m_inputs, audio_ports->m_outputs);
 
     // check our active config, which requires valid mappings
     const uint32_t input_count = (uint32_t)audio_ports->m_inputs.size();
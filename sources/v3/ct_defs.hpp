@@ -2,6 +2,9 @@
 #include "utility/ct_safe_fnptr.hpp"
 #include "utility/ct_messages.hpp"
 #include "utility/ct_scope.hpp"
+#include "utility/ct_rt_memory.hpp"
+#include "utility/ct_trace.hpp"
+#include "utility/ct_rt_audit.hpp"
 #include <cstddef>
 
 // A custom UUID used as namespace for VST3 identifiers.
@@ -11,7 +14,17 @@ static const unsigned char v3_wrapper_namespace_uuid[16] = {0x18, 0xae, 0xbb, 0x
 //
 enum {
     ct_events_buffer_capacity = 65536,
+    ct_events_buffer_max_capacity = 16 * 1024 * 1024,
+    ct_events_buffer_overflow_chunks = 2,
     ct_port_max_channels = 64,
+    ct_cache_line_size = 64,
+    ct_scratch_max_arenas = 256,
+    ct_thread_pool_max_jobs = 64,
+    ct_log_queue_capacity = 1024,
+    ct_log_source_size = 32,
+    ct_log_text_size = 200,
+    ct_log_file_max_size = 4 * 1024 * 1024,
+    ct_timing_buckets = 32,
 };
 
 //
@@ -19,15 +32,150 @@ enum {
     v3_idle_timer_interval = 50,
 };
 
+// Maximum deviation of an automation point from a linear ramp, for it to be
+// considered part of the ramp (in normalized units)
+static constexpr double ct_automation_ramp_tolerance = 1e-4;
+
+// Duration of the crossfade when the wrapper engages or releases the bypass
+// (in seconds)
+static constexpr double ct_bypass_crossfade_time = 10e-3;
+
 // Platform definitions
 #if !defined (_WIN32) && !defined(__APPLE__)
 #   define CT_X11 1
 #endif
 
+// Enable to build the call tracing, which the environment variable `CT_TRACE`
+// turns on at runtime, see `trace_recorder`
+#if !defined(CT_TRACING)
+#   define CT_TRACING 1
+#endif
+
+#if CT_TRACING
+#   define CT_TRACE_SCOPE(name) ::ct::trace_scope trace__scope{(name)}
+#   define CT_CLAP_CALL_TRACE(member) ::ct::trace_scope{"clap: " #member},
+#else
+#   define CT_TRACE_SCOPE(name)
+#   define CT_CLAP_CALL_TRACE(member)
+#endif
+
+// Enable to audit the real-time safety of the audio thread, counting the
+// allocations, locks and blocking calls of the wrapper and the plugin during
+// processing, see `rt_audit` (Linux only)
+#if !defined(CT_RT_AUDIT)
+#   define CT_RT_AUDIT 0
+#endif
+
+#if CT_RT_AUDIT
+#   define CT_CLAP_CALL_AUDIT ::ct::rt_audit_plugin_scope{},
+#else
+#   define CT_CLAP_CALL_AUDIT
+#endif
+
 // Helper to invoke CLAP function pointers safely
 // (allows to insert logging if desired)
-#define CLAP_CALL(self, member, ...) \
-    ::ct::safe_fnptr_access_call((self), +[](decltype(self) x) { return x->member; }, ##__VA_ARGS__)
+#define CLAP_CALL(self, member, ...)                                    \
+    (CT_CLAP_CALL_TRACE(member) CT_CLAP_CALL_AUDIT                      \
+     ::ct::safe_fnptr_access_call((self), +[](decltype(self) x) { return x->member; }, ##__VA_ARGS__))
+
+// Enable to let the plugin read host input buffers without copying them,
+// whenever it cannot overwrite them during processing
+#define CT_ZERO_COPY_INPUTS 1
+
+// Enable to count how often audio channels are flagged silent or constant,
+// and print the numbers when the plugin deactivates
+#define CT_SILENCE_STATISTICS 0
+
+// Enable to print the memory of the buffers shared between instances, and
+// what they would take unshared, when the plugin deactivates
+#define CT_FOOTPRINT_STATISTICS 0
+
+// Enable to reduce the automation points exchanged with the host, by merging
+// simultaneous points, and removing redundant points and ramp midpoints
+#if !defined(CT_AUTOMATION_COALESCING)
+#   define CT_AUTOMATION_COALESCING 0
+#endif
+
+// Enable to bypass the plugin in the wrapper, when the host sets the bypass
+// parameter, instead of processing it
+#if !defined(CT_WRAPPER_BYPASS)
+#   define CT_WRAPPER_BYPASS 0
+#endif
+
+// Size of the blocks which the plugin processes, or zero to follow the host.
+// A fixed size adds a latency of one block, which is reported to the host.
+#if !defined(CT_FIXED_BLOCK_SIZE)
+#   define CT_FIXED_BLOCK_SIZE 0
+#endif
+static_assert((CT_FIXED_BLOCK_SIZE & (CT_FIXED_BLOCK_SIZE - 1)) == 0, "The fixed block size must be a power of two");
+
+// Alignment of the processing buffers, a power of two, for the widest vectors
+// which plugins may use; the tables are always aligned to the cache line
+#if !defined(CT_BUFFER_ALIGNMENT)
+#   define CT_BUFFER_ALIGNMENT 64
+#endif
+static_assert(CT_BUFFER_ALIGNMENT > 0 && (CT_BUFFER_ALIGNMENT & (CT_BUFFER_ALIGNMENT - 1)) == 0, "The buffer alignment must be a power of two");
+
+// Enable to lock the processing buffers in physical memory, so they are never
+// paged out; this is limited by the system, see RLIMIT_MEMLOCK on Linux
+#if !defined(CT_LOCK_BUFFERS)
+#   define CT_LOCK_BUFFERS 0
+#endif
+
+// Enable to request transparent huge pages for the large processing buffers
+#if !defined(CT_HUGE_PAGE_BUFFERS)
+#   define CT_HUGE_PAGE_BUFFERS 0
+#endif
+
+// Alignment and allocation flags of the processing buffers
+static constexpr size_t ct_buffer_alignment = (CT_BUFFER_ALIGNMENT > ct_cache_line_size) ? CT_BUFFER_ALIGNMENT : ct_cache_line_size;
+static constexpr uint32_t ct_buffer_memory_flags =
+    (CT_LOCK_BUFFERS ? ct::rt_memory::lock : 0u) | (CT_HUGE_PAGE_BUFFERS ? ct::rt_memory::huge_pages : 0u);
+
+// Enable to flush denormals while the plugin processes, and to scrub its
+// output: channels with infinity or NaN are muted, subnormals become zero
+#if !defined(CT_OUTPUT_SANITIZER)
+#   define CT_OUTPUT_SANITIZER 0
+#endif
+
+// Enable to offer `clap.thread-pool` to the plugin, executing its tasks on
+// workers shared by all instances
+#if !defined(CT_HOST_THREAD_POOL)
+#   define CT_HOST_THREAD_POOL 1
+#endif
+
+// Enable to time the processing of each instance, separating the plugin from
+// the wrapper, and to report the blocks which come close to missing the
+// deadline, above the fraction of the budget given in percent
+#if !defined(CT_PROCESS_TIMING)
+#   define CT_PROCESS_TIMING 1
+#endif
+#if !defined(CT_DEADLINE_THRESHOLD)
+#   define CT_DEADLINE_THRESHOLD 80
+#endif
+static_assert(CT_DEADLINE_THRESHOLD > 0, "The deadline threshold must be positive");
+
+// Enable to publish live statistics of the instances in shared memory, which
+// the tool `ct-top` displays, see `ct_live_stats` (POSIX only)
+#if !defined(CT_LIVE_STATS)
+#   if !defined(_WIN32)
+#       define CT_LIVE_STATS 1
+#   else
+#       define CT_LIVE_STATS 0
+#   endif
+#endif
+
+// File which receives the log, rotated when it's full, or empty for the
+// standard error
+#if !defined(CT_LOG_FILE)
+#   define CT_LOG_FILE ""
+#endif
+
+// Lowest severity of the messages which are logged
+// (0 = debug, 1 = info, 2 = warning, 3 = error)
+#if !defined(CT_LOG_LEVEL)
+#   define CT_LOG_LEVEL 1
+#endif
 
 // Enable to print trace messages
 #define VERBOSE_PLUGIN_CALLS 0
@@ -39,16 +187,18 @@ enum {
 #endif
 
 #if !VERBOSE_PLUGIN_CALLS
-#   define LOG_PLUGIN_CALL
-#   define LOG_PLUGIN_SELF_CALL(self)
+#   define LOG_PLUGIN_CALL CT_TRACE_SCOPE(CT_FUNCSIG)
+#   define LOG_PLUGIN_SELF_CALL(self) CT_TRACE_SCOPE(CT_FUNCSIG)
 #   define LOG_PLUGIN_RET(ret) return (ret)
 #   define LOG_PLUGIN_RET_PTR(ret) return (ret)
 #else
 #   define LOG_PLUGIN_CALL                                              \
+    CT_TRACE_SCOPE(CT_FUNCSIG);                                         \
     ::ct::plugin_call__enter(nullptr, CT_FUNCSIG);                      \
     auto plugin_call__guard = ct::defer([]() { ct::plugin_call__leave(); })
 
 #   define LOG_PLUGIN_SELF_CALL(self)                                   \
+    CT_TRACE_SCOPE(CT_FUNCSIG);                                         \
     ::ct::plugin_call__enter((self), CT_FUNCSIG);                       \
     auto plugin_call__guard = ct::defer([]() { ct::plugin_call__leave(); })
 
@@ -46,6 +46,8 @@ v3_result V3_API ct_edit_controller::initialize(void *self_, v3_funknown** conte
 {
     LOG_PLUGIN_SELF_CALL(self_);
 
+    ct_thread_role_scope role{ct_thread_role_main};
+
     ct_edit_controller *self = (ct_edit_controller *)self_;
     ct_component *comp = self->m_comp;
     LOG_PLUGIN_RET(comp->m_vptr->i_plug.initialize(comp, context));
@@ -55,6 +57,8 @@ v3_result V3_API ct_edit_controller::terminate(void *self_)
 {
     LOG_PLUGIN_SELF_CALL(self_);
 
+    ct_thread_role_scope role{ct_thread_role_main};
+
     ct_edit_controller *self = (ct_edit_controller *)self_;
     ct_component *comp = self->m_comp;
     LOG_PLUGIN_RET(comp->m_vptr->i_plug.terminate(comp));
@@ -75,6 +79,8 @@ v3_result V3_API ct_edit_controller::set_state(void *self_, v3_bstream **stream_
 {
     LOG_PLUGIN_SELF_CALL(self_);
 
+    ct_thread_role_scope role{ct_thread_role_main};
+
     ct_edit_controller *self = (ct_edit_controller *)self_;
     ct_component *comp = self->m_comp;
 
@@ -156,6 +162,8 @@ v3_result V3_API ct_edit_controller::get_parameter_string_for_value(void *self_,
 {
     LOG_PLUGIN_SELF_CALL(self_);
 
+    ct_thread_role_scope role{ct_thread_role_main};
+
     ct_edit_controller *self = (ct_edit_controller *)self_;
     ct_component *comp = self->m_comp;
     const clap_plugin *plug = comp->m_plug;
@@ -179,6 +187,8 @@ v3_result V3_API ct_edit_controller::get_parameter_value_for_string(void *self_,
 {
     LOG_PLUGIN_SELF_CALL(self_);
 
+    ct_thread_role_scope role{ct_thread_role_main};
+
     ct_edit_controller *self = (ct_edit_controller *)self_;
     ct_component *comp = self->m_comp;
     const clap_plugin *plug = comp->m_plug;
@@ -317,6 +327,8 @@ v3_plugin_view **V3_API ct_edit_controller::create_view(void *self_, const char
 {
     LOG_PLUGIN_SELF_CALL(self_);
 
+    ct_thread_role_scope role{ct_thread_role_main};
+
     ct_edit_controller *self = (ct_edit_controller *)self_;
     ct_component *comp = self->m_comp;
     ct_plug_view *view = nullptr;
@@ -1,9 +1,9 @@
 #include "ct_event_conversion.hpp"
 #include "ct_events.hpp"
 #include "ct_component.hpp"
+#include "ct_param_feedback.hpp"
 #include "clap_helpers.hpp"
 #include <travesty/events.h>
-#include <cstring>
 #include <cstdlib>
 
 namespace ct {
@@ -11,6 +11,12 @@ namespace ct {
 event_converter_v3_to_clap::event_converter_v3_to_clap(ct_component *comp)
     : m_cache{comp->m_cache->get_params()}
 {
+#if CT_AUTOMATION_COALESCING
+    uint32_t param_count = (uint32_t)m_cache->m_params.size();
+    m_coalescers.resize(param_count);
+    for (uint32_t i = 0; i < param_count; ++i)
+        m_coalescers[i].configure(&m_cache->m_params[i]);
+#endif
 }
 
 void event_converter_v3_to_clap::transfer()
@@ -28,12 +34,29 @@ void event_converter_v3_to_clap::transfer()
             if (npoints < 1)
                 continue;
             v3_param_id id = vq->m_vptr->i_queue.get_param_id(vq);
-            for (int32_t ipoint = npoints; ipoint-- > 0; ) {
+#if CT_AUTOMATION_COALESCING
+            const uint32_t *param_indexp = cache->m_param_idx_by_id.find(id);
+            if (!param_indexp)
+                continue;
+            ct_automation_coalescer &coalescer = m_coalescers[*param_indexp];
+            auto emit = [id, cache, out](int32_t offset, double value) {
+                convert_parameter_change(id, offset, value, cache, out);
+            };
+            for (int32_t ipoint = 0; ipoint < npoints; ++ipoint) {
+                int32_t raw_offset = 0;
+                double value = 0;
+                if (vq->m_vptr->i_queue.get_point(vq, ipoint, &raw_offset, &value) == V3_OK)
+                    coalescer.push(raw_offset, value, emit);
+            }
+            coalescer.flush(emit);
+#else
+            for (int32_t ipoint = 0; ipoint < npoints; ++ipoint) {
                 int32_t raw_offset = 0;
                 double value = 0;
                 if (vq->m_vptr->i_queue.get_point(vq, ipoint, &raw_offset, &value) == V3_OK)
                     convert_parameter_change(id, raw_offset, value, cache, out);
             }
+#endif
         }
     }
 
@@ -47,7 +70,7 @@ void event_converter_v3_to_clap::transfer()
     }
 
     if (m_sort)
-        out->sort_events_by_time(); //XXX could improve
+        out->sort_events_by_time();
 }
 
 uint32_t event_converter_v3_to_clap::fix_offset(int32_t offset)
@@ -60,76 +83,79 @@ void event_converter_v3_to_clap::convert_event(const v3_event *event, ct_events_
     switch (event->type) {
     case V3_EVENT_NOTE_ON:
     {
-        clap_event_note ce{};
-        ce.header.size = sizeof(ce);
-        ce.header.time = fix_offset(event->sample_offset);
-        ce.header.space_id = CLAP_CORE_EVENT_SPACE_ID;
-        ce.header.type = CLAP_EVENT_NOTE_ON;
-        ce.header.flags = (event->flags & V3_EVENT_IS_LIVE) ? CLAP_EVENT_IS_LIVE : 0;
-        ce.note_id = event->note_on.note_id;
-        ce.port_index = event->bus_index;
-        ce.key = event->note_on.pitch;
-        ce.channel = event->note_on.channel;
-        ce.velocity = event->note_on.velocity;
-        result->add(&ce.header);
+        clap_event_note *ce = result->emplace<clap_event_note>();
+        if (!ce)
+            break;
+        ce->header.time = fix_offset(event->sample_offset);
+        ce->header.space_id = CLAP_CORE_EVENT_SPACE_ID;
+        ce->header.type = CLAP_EVENT_NOTE_ON;
+        ce->header.flags = (event->flags & V3_EVENT_IS_LIVE) ? CLAP_EVENT_IS_LIVE : 0;
+        ce->note_id = event->note_on.note_id;
+        ce->port_index = event->bus_index;
+        ce->key = event->note_on.pitch;
+        ce->channel = event->note_on.channel;
+        ce->velocity = event->note_on.velocity;
+        result->commit();
     }
     break;
 
     case V3_EVENT_NOTE_OFF:
     {
-        clap_event_note ce{};
-        ce.header.size = sizeof(ce);
-        ce.header.time = fix_offset(event->sample_offset);
-        ce.header.space_id = CLAP_CORE_EVENT_SPACE_ID;
-        ce.header.type = CLAP_EVENT_NOTE_OFF;
-        ce.header.flags = (event->flags & V3_EVENT_IS_LIVE) ? CLAP_EVENT_IS_LIVE : 0;
-        ce.port_index = event->bus_index;
-        ce.note_id = event->note_off.note_id;
-        ce.key = event->note_off.pitch;
-        ce.channel = event->note_off.channel;
-        ce.velocity = event->note_off.velocity;
-        result->add(&ce.header);
+        clap_event_note *ce = result->emplace<clap_event_note>();
+        if (!ce)
+            break;
+        ce->header.time = fix_offset(event->sample_offset);
+        ce->header.space_id = CLAP_CORE_EVENT_SPACE_ID;
+        ce->header.type = CLAP_EVENT_NOTE_OFF;
+        ce->header.flags = (event->flags & V3_EVENT_IS_LIVE) ? CLAP_EVENT_IS_LIVE : 0;
+        ce->port_index = event->bus_index;
+        ce->note_id = event->note_off.note_id;
+        ce->key = event->note_off.pitch;
+        ce->channel = event->note_off.channel;
+        ce->velocity = event->note_off.velocity;
+        result->commit();
     }
     break;
 
     case V3_EVENT_NOTE_EXP_VALUE:
     {
-        clap_event_note_expression ce{};
-        ce.header.size = sizeof(ce);
-        ce.header.time = fix_offset(event->sample_offset);
-        ce.header.space_id = CLAP_CORE_EVENT_SPACE_ID;
-        ce.header.type = CLAP_EVENT_NOTE_EXPRESSION;
-        ce.header.flags = (event->flags & V3_EVENT_IS_LIVE) ? CLAP_EVENT_IS_LIVE : 0;
-        ce.note_id = event->note_exp_value.note_id;
-        ce.port_index = event->bus_index;
-        ce.key = -1; // don't have it
-        ce.channel = -1;
-        ce.value = event->note_exp_value.value;
+        clap_event_note_expression *ce = result->emplace<clap_event_note_expression>();
+        if (!ce)
+            break;
+        ce->header.time = fix_offset(event->sample_offset);
+        ce->header.space_id = CLAP_CORE_EVENT_SPACE_ID;
+        ce->header.type = CLAP_EVENT_NOTE_EXPRESSION;
+        ce->header.flags = (event->flags & V3_EVENT_IS_LIVE) ? CLAP_EVENT_IS_LIVE : 0;
+        ce->note_id = event->note_exp_value.note_id;
+        ce->port_index = event->bus_index;
+        ce->key = -1; // don't have it
+        ce->channel = -1;
+        ce->value = event->note_exp_value.value;
         if (event->note_exp_value.type_id == 0) {
-            ce.expression_id = CLAP_NOTE_EXPRESSION_VOLUME;
-            ce.value = 4 * ce.value;
+            ce->expression_id = CLAP_NOTE_EXPRESSION_VOLUME;
+            ce->value = 4 * ce->value;
         }
         else if (event->note_exp_value.type_id == 1) {
-            ce.expression_id = CLAP_NOTE_EXPRESSION_PAN;
+            ce->expression_id = CLAP_NOTE_EXPRESSION_PAN;
         }
         else if (event->note_exp_value.type_id == 2) {
-            ce.expression_id = CLAP_NOTE_EXPRESSION_TUNING;
-            ce.value *= 240;
-            ce.value -= 120;
+            ce->expression_id = CLAP_NOTE_EXPRESSION_TUNING;
+            ce->value *= 240;
+            ce->value -= 120;
         }
         else if (event->note_exp_value.type_id == 3) {
-            ce.expression_id = CLAP_NOTE_EXPRESSION_VIBRATO;
+            ce->expression_id = CLAP_NOTE_EXPRESSION_VIBRATO;
         }
         else if (event->note_exp_value.type_id == 4) {
-            ce.expression_id = CLAP_NOTE_EXPRESSION_EXPRESSION;
+            ce->expression_id = CLAP_NOTE_EXPRESSION_EXPRESSION;
         }
         else if (event->note_exp_value.type_id == 5) {
-            ce.expression_id = CLAP_NOTE_EXPRESSION_BRIGHTNESS;
+            ce->expression_id = CLAP_NOTE_EXPRESSION_BRIGHTNESS;
         }
         else {
-            break;
+            break; // not committed, the reservation is discarded
         }
-        result->add(&ce.header);
+        result->commit();
     }
     break;
     }
@@ -141,23 +167,56 @@ void event_converter_v3_to_clap::convert_parameter_change(uint32_t id, int32_t o
     if (!info)
         return;
 
-    clap_event_param_value ce{};
-    ce.header.size = sizeof(ce);
-    ce.header.time = fix_offset(offset);
-    ce.header.space_id = CLAP_CORE_EVENT_SPACE_ID;
-    ce.header.type = CLAP_EVENT_PARAM_VALUE;
-    ce.param_id = id;
-    ce.port_index = -1;
-    ce.value = denormalize_parameter_value(info, value);
-    result->add(&ce.header);
+    clap_event_param_value *ce = result->emplace<clap_event_param_value>();
+    if (!ce)
+        return;
+    ce->header.time = fix_offset(offset);
+    ce->header.space_id = CLAP_CORE_EVENT_SPACE_ID;
+    ce->header.type = CLAP_EVENT_PARAM_VALUE;
+    ce->param_id = id;
+    ce->port_index = -1;
+    ce->value = denormalize_parameter_value(info, value);
+    result->commit();
 }
 
 //------------------------------------------------------------------------------
 event_converter_clap_to_v3::event_converter_clap_to_v3(ct_component *comp)
-    : m_cache{comp->m_cache->get_params()}
+    : m_cache{comp->m_cache->get_params()},
+      m_feedback{&comp->m_param_feedback}
 {
     // reserve parameter memory
-    m_queues.resize(m_cache->m_params.size());
+    uint32_t param_count = (uint32_t)m_cache->m_params.size();
+    m_queues.resize(param_count);
+    m_touched_queues.reserve(param_count);
+
+#if CT_AUTOMATION_COALESCING
+    m_coalescers.resize(param_count);
+    for (uint32_t i = 0; i < param_count; ++i)
+        m_coalescers[i].configure(&m_cache->m_params[i]);
+    m_pending_coalescers.reserve(param_count);
+#endif
+}
+
+v3::param_value_queue *event_converter_clap_to_v3::get_output_queue(uint32_t param_index)
+{
+    v3::param_changes *pcs = m_pcs;
+    v3::param_value_queue *queue = m_queues[param_index];
+    v3::param_value_queue *invalid_queue = (v3::param_value_queue *)0x1;
+
+    if (!queue) {
+        v3_param_id id = m_cache->m_params[param_index].id;
+        int32_t queue_index = 0;
+        queue = (v3::param_value_queue *)pcs->m_vptr->i_changes.add_param_data(pcs, &id, &queue_index);
+        if (!queue)
+            queue = invalid_queue;
+        m_queues[param_index] = queue;
+        m_touched_queues.push_back(param_index);
+    }
+
+    if (queue == invalid_queue)
+        return nullptr;
+
+    return queue;
 }
 
 void event_converter_clap_to_v3::transfer()
@@ -165,13 +224,13 @@ void event_converter_clap_to_v3::transfer()
     const ct_events_buffer *in = m_in;
     v3::param_changes *pcs = m_pcs;
     v3::event_list *evs = m_evs;
-    uint32_t count = in->count();
 
-    if (pcs)
-        std::memset(m_queues.data(), 0, m_queues.size() * sizeof(v3::param_value_queue *));
+    // reset only the queues used in the previous block
+    for (uint32_t param_index : m_touched_queues)
+        m_queues[param_index] = nullptr;
+    m_touched_queues.clear();
 
-    for (uint32_t i = 0; i < count; ++i) {
-        const clap_event_header *hdr = in->get(i);
+    for (const clap_event_header *hdr : in->events()) {
 
         // TODO event ppq position (1/4 beats)
         auto event_ppq_position = []() -> double {
@@ -267,9 +326,6 @@ void event_converter_clap_to_v3::transfer()
 
         case CLAP_EVENT_PARAM_VALUE:
         {
-            if (!pcs)
-                break;
-
             const clap_event_param_value *ce = (const clap_event_param_value *)hdr;
             clap_id id = ce->param_id;
 
@@ -278,27 +334,52 @@ void event_converter_clap_to_v3::transfer()
                 break;
 
             const uint32_t param_index = *param_indexp;
-            v3::param_value_queue *queue = m_queues[param_index];
-            v3::param_value_queue *invalid_queue = (v3::param_value_queue *)0x1;
-
-            if (!queue) {
-                int32_t queue_index = 0;
-                queue = (v3::param_value_queue *)pcs->m_vptr->i_changes.add_param_data(pcs, &id, &queue_index);
-                if (!queue)
-                    queue = invalid_queue;
-                m_queues[param_index] = queue;
-            }
+            const clap_param_info &info = m_cache->m_params[param_index];
 
-            if (queue == invalid_queue)
+            // let the controller know the value
+            m_feedback->publish(param_index, ce->value);
+
+            // values of meters are only of interest to the controller
+            bool is_meter = (info.flags & CLAP_PARAM_IS_READONLY) && !(info.flags & CLAP_PARAM_IS_AUTOMATABLE);
+            if (!pcs || is_meter)
                 break;
 
-            double normalized = normalize_parameter_value(&m_cache->m_params[param_index], ce->value);
-            int32_t value_index = 0;
-            queue->m_vptr->i_queue.add_point(queue, (int32_t)hdr->time, normalized, &value_index);
+            double normalized = normalize_parameter_value(&info, ce->value);
+
+#if CT_AUTOMATION_COALESCING
+            ct_automation_coalescer &coalescer = m_coalescers[param_index];
+            if (!coalescer.has_pending())
+                m_pending_coalescers.push_back(param_index);
+            coalescer.push((int32_t)hdr->time, normalized, [this, param_index](int32_t offset, double value) {
+                add_output_point(param_index, offset, value);
+            });
+#else
+            add_output_point(param_index, (int32_t)hdr->time, normalized);
+#endif
         }
         break;
         }
     }
+
+#if CT_AUTOMATION_COALESCING
+    // terminate the automation of this block
+    for (uint32_t param_index : m_pending_coalescers) {
+        m_coalescers[param_index].flush([this, param_index](int32_t offset, double value) {
+            add_output_point(param_index, offset, value);
+        });
+    }
+    m_pending_coalescers.clear();
+#endif
+}
+
+void event_converter_clap_to_v3::add_output_point(uint32_t param_index, int32_t offset, double value)
+{
+    v3::param_value_queue *queue = get_output_queue(param_index);
+    if (!queue)
+        return;
+
+    int32_t value_index = 0;
+    queue->m_vptr->i_queue.add_point(queue, offset, value, &value_index);
 }
 
 //------------------------------------------------------------------------------
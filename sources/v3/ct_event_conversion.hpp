@@ -1,5 +1,6 @@
 #pragma once
 #include "ct_component_caches.hpp"
+#include "ct_automation_coalescer.hpp"
 #include "travesty_helpers.hpp"
 #include <vector>
 #include <cstdint>
@@ -10,6 +11,7 @@ namespace ct {
 
 struct ct_component;
 class ct_events_buffer;
+class ct_param_feedback;
 
 //------------------------------------------------------------------------------
 class event_converter_v3_to_clap {
@@ -31,6 +33,9 @@ private:
     ct_events_buffer *m_out = nullptr;
     bool m_sort = true;
     const ct_caches::params_t *m_cache = nullptr;
+#if CT_AUTOMATION_COALESCING
+    std::vector<ct_automation_coalescer> m_coalescers;
+#endif
 };
 
 //------------------------------------------------------------------------------
@@ -41,12 +46,22 @@ public:
     void set_output(v3::param_changes *pcs, v3::event_list *evs) { m_pcs = pcs; m_evs = evs; }
     void transfer();
 
+private:
+    v3::param_value_queue *get_output_queue(uint32_t param_index);
+    void add_output_point(uint32_t param_index, int32_t offset, double value);
+
 private:
     const ct_events_buffer *m_in = nullptr;
     v3::param_changes *m_pcs = nullptr;
     v3::event_list *m_evs = nullptr;
     const ct_caches::params_t *m_cache = nullptr;
+    ct_param_feedback *m_feedback = nullptr;
     std::vector<v3::param_value_queue *> m_queues;
+    std::vector<uint32_t> m_touched_queues;
+#if CT_AUTOMATION_COALESCING
+    std::vector<ct_automation_coalescer> m_coalescers;
+    std::vector<uint32_t> m_pending_coalescers;
+#endif
 };
 
 //------------------------------------------------------------------------------
@@ -1,44 +1,110 @@
 #include "ct_events.hpp"
+#include "ct_defs.hpp"
 #include "utility/ct_assert.hpp"
-#include "libs/heapsort.hpp"
+#include <algorithm>
+#include <utility>
 #include <cstring>
 
 namespace ct {
 
 ct_events_buffer::ct_events_buffer(uint32_t capacity)
+{
+    reconfigure(capacity);
+}
+
+void ct_events_buffer::reconfigure(uint32_t capacity)
 {
     constexpr uint32_t alignval = alignof(clap_event_header);
 
     uint32_t aligned_capacity = (capacity + (alignval - 1)) & ~(alignval - 1);
-    m_buf.reset(new uint8_t[aligned_capacity]);
-    m_capa = aligned_capacity;
+    uint32_t chunk_count = 1 + ct_events_buffer_overflow_chunks;
+
+    m_chunks.reset(new std::unique_ptr<uint8_t[]>[chunk_count]);
+    for (uint32_t i = 0; i < chunk_count; ++i)
+        m_chunks[i].reset(new uint8_t[aligned_capacity]);
+    m_chunk_count = chunk_count;
+    m_chunk_capa = aligned_capacity;
+
+    uint32_t max_count = chunk_count * (aligned_capacity / sizeof(clap_event_header));
+    m_ind.reset(new const clap_event_header *[max_count]);
+    m_sort_keys.reset(new uint32_t[2 * max_count]);
+    m_sort_ind.reset(new const clap_event_header *[max_count]);
+    m_max_count = max_count;
 
-    uint32_t max_count = aligned_capacity / sizeof(clap_event_header);
-    m_ind.reset(new uint32_t[max_count]);
+    m_chunk_index = 0;
+    m_fill = 0;
+    m_used = 0;
+    m_pending_size = 0;
+    m_count = 0;
 }
 
 bool ct_events_buffer::add(const clap_event_header *event) noexcept
+{
+    void *dst = reserve(event->size);
+    if (!dst)
+        return false;
+
+    std::memcpy(dst, event, event->size);
+    commit();
+    return true;
+}
+
+void *ct_events_buffer::reserve(uint32_t size) noexcept
 {
     constexpr uint32_t alignval = alignof(clap_event_header);
 
     static_assert(sizeof(clap_event_header) > alignval);
 
-    uint32_t size = event->size;
     CT_ASSERT(size >= sizeof(clap_event_header));
 
+    uint32_t aligned_size = (size + (alignval - 1)) & ~(alignval - 1);
+
+    uint32_t chunk_index = m_chunk_index;
     uint32_t fill = m_fill;
-    if (size > m_capa - fill)
-        return false;
+    if (aligned_size > m_chunk_capa - fill) {
+        // continue into the next overflow chunk, if there is one
+        if (aligned_size > m_chunk_capa || chunk_index + 1 >= m_chunk_count) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            m_pending_size = 0;
+            return nullptr;
+        }
+        ++chunk_index;
+        fill = 0;
+    }
+
+    if (m_count >= m_max_count) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        m_pending_size = 0;
+        return nullptr;
+    }
 
     CT_ASSERT(fill % alignval == 0);
-    std::memcpy(&m_buf[fill], event, size);
+    m_pending_chunk = chunk_index;
+    m_pending_fill = fill;
+    m_pending_size = aligned_size;
 
-    m_ind[m_count++] = fill;
+    return &m_chunks[chunk_index][fill];
+}
 
-    uint32_t aligned_size = (size + (alignval - 1)) & ~(alignval - 1);
-    m_fill = fill + aligned_size;
+void ct_events_buffer::commit() noexcept
+{
+    CT_ASSERT(m_pending_size > 0);
 
-    return true;
+    if (m_pending_chunk != m_chunk_index && m_chunk_index == 0)
+        m_overflows.fetch_add(1, std::memory_order_relaxed);
+
+    clap_event_header *hdr = (clap_event_header *)&m_chunks[m_pending_chunk][m_pending_fill];
+    if (m_time_offset != 0) {
+        int64_t time = (int64_t)hdr->time + m_time_offset;
+        hdr->time = (uint32_t)std::max<int64_t>(time, 0);
+    }
+
+    m_ind[m_count++] = hdr;
+
+    m_chunk_index = m_pending_chunk;
+    m_fill = m_pending_fill + m_pending_size;
+    m_used += m_pending_size;
+    m_pending_size = 0;
 }
 
 const clap_event_header *ct_events_buffer::get(uint32_t index) const noexcept
@@ -46,23 +112,110 @@ const clap_event_header *ct_events_buffer::get(uint32_t index) const noexcept
     if (index >= m_count)
         return nullptr;
 
-    return (const clap_event_header *)&m_buf[m_ind[index]];
+    return m_ind[index];
 }
 
 void ct_events_buffer::clear() noexcept
 {
+    update_high_water();
+
+    m_chunk_index = 0;
     m_fill = 0;
+    m_used = 0;
+    m_pending_size = 0;
     m_count = 0;
 }
 
+void ct_events_buffer::update_high_water() noexcept
+{
+    // NOTE: only the thread which adds events will update these
+    if (m_used > m_high_water_bytes.load(std::memory_order_relaxed))
+        m_high_water_bytes.store(m_used, std::memory_order_relaxed);
+    if (m_count > m_high_water_count.load(std::memory_order_relaxed))
+        m_high_water_count.store(m_count, std::memory_order_relaxed);
+}
+
+ct_events_buffer::statistics ct_events_buffer::get_statistics() const noexcept
+{
+    statistics st;
+    st.m_high_water_bytes = m_high_water_bytes.load(std::memory_order_relaxed);
+    st.m_high_water_count = m_high_water_count.load(std::memory_order_relaxed);
+    st.m_overflows = m_overflows.load(std::memory_order_relaxed);
+    st.m_dropped = m_dropped.load(std::memory_order_relaxed);
+    return st;
+}
+
+size_t ct_events_buffer::memory_size() const noexcept
+{
+    return (size_t)m_chunk_count * m_chunk_capa +
+        (size_t)m_max_count * (2 * sizeof(const clap_event_header *) + 2 * sizeof(uint32_t));
+}
+
+void ct_events_buffer::reset_statistics() noexcept
+{
+    m_high_water_bytes.store(0, std::memory_order_relaxed);
+    m_high_water_count.store(0, std::memory_order_relaxed);
+    m_overflows.store(0, std::memory_order_relaxed);
+    m_dropped.store(0, std::memory_order_relaxed);
+}
+
+// Sort by time using a stable radix sort, so that simultaneous events remain
+// in order of insertion. Event times are bounded by the block size, so this
+// usually takes one or two passes, and no pass at all if already in order.
 void ct_events_buffer::sort_events_by_time()
 {
-    auto compare = [this](uint32_t a_pos, uint32_t b_pos) {
-        const clap_event_header *a = (const clap_event_header *)&m_buf[a_pos];
-        const clap_event_header *b = (const clap_event_header *)&m_buf[b_pos];
-        return a->time < b->time;
-    };
-    heapsort::heapsort(&m_ind[0], &m_ind[m_count], compare);
+    uint32_t count = m_count;
+    const clap_event_header **ind = m_ind.get();
+
+    uint32_t *keys = &m_sort_keys[0];
+    uint32_t *tmp_keys = &m_sort_keys[count];
+    const clap_event_header **tmp_ind = m_sort_ind.get();
+
+    // extract keys, and check if any sorting is needed
+    bool sorted = true;
+    uint32_t key_bits = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        uint32_t key = ind[i]->time;
+        sorted = sorted && (i == 0 || keys[i - 1] <= key);
+        key_bits |= key;
+        keys[i] = key;
+    }
+
+    if (sorted)
+        return;
+
+    // sort 8 bits at a time, up to the most significant bit in use
+    constexpr uint32_t radix_bits = 8;
+    constexpr uint32_t radix_size = 1u << radix_bits;
+
+    for (uint32_t shift = 0; shift < 32 && (key_bits >> shift) != 0; shift += radix_bits) {
+        uint32_t histogram[radix_size] = {};
+        for (uint32_t i = 0; i < count; ++i)
+            ++histogram[(keys[i] >> shift) & (radix_size - 1)];
+
+        // skip if all keys share this digit
+        if (histogram[(keys[0] >> shift) & (radix_size - 1)] == count)
+            continue;
+
+        uint32_t offset = 0;
+        for (uint32_t d = 0; d < radix_size; ++d) {
+            uint32_t n = histogram[d];
+            histogram[d] = offset;
+            offset += n;
+        }
+
+        for (uint32_t i = 0; i < count; ++i) {
+            uint32_t pos = histogram[(keys[i] >> shift) & (radix_size - 1)]++;
+            tmp_keys[pos] = keys[i];
+            tmp_ind[pos] = ind[i];
+        }
+
+        std::swap(keys, tmp_keys);
+        std::swap(ind, tmp_ind);
+    }
+
+    if (ind != m_ind.get())
+        std::memcpy(m_ind.get(), ind, count * sizeof(const clap_event_header *));
 }
 
 clap_input_events ct_events_buffer::as_clap_input() const noexcept
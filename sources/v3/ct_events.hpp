@@ -1,29 +1,99 @@
 #pragma once
+#include "libs/span.hpp"
 #include <clap/clap.h>
 #include <memory>
+#include <new>
+#include <atomic>
 #include <cstdint>
 
 namespace ct {
 
+// A buffer of events, which does not allocate memory after configuration.
+// Events are stored in a primary chunk, followed by preallocated overflow
+// chunks when the load is higher than expected.
 class ct_events_buffer {
 public:
     explicit ct_events_buffer(uint32_t capacity);
+    void reconfigure(uint32_t capacity);
+    uint32_t capacity() const noexcept { return m_chunk_capa; }
+
     bool add(const clap_event_header *event) noexcept;
     const clap_event_header *get(uint32_t index) const noexcept;
     void clear() noexcept;
     uint32_t count() const noexcept { return m_count; }
 
+    // get aligned storage for an event of the given size, to be constructed in
+    // place, and added by `commit`; returns null if it does not fit
+    // NOTE: a reservation which is not committed is discarded by the next one
+    void *reserve(uint32_t size) noexcept;
+    void commit() noexcept;
+
+    // construct an event of the given type in place, with its header size set
+    // and zero elsewhere; after filling it, add it with `commit`
+    template <class T> T *emplace() noexcept;
+
+    // the events in order, without bounds checking
+    nonstd::span<const clap_event_header *const> events() const noexcept { return {m_ind.get(), m_count}; }
+
+    // shift the time of the events which are added next, clamping at zero
+    void set_time_offset(int32_t offset) noexcept { m_time_offset = offset; }
+
     void sort_events_by_time();
 
     clap_input_events as_clap_input() const noexcept;
     clap_output_events as_clap_output() noexcept;
 
+    // load counters, for sizing the buffers
+    struct statistics {
+        uint32_t m_high_water_bytes = 0; // peak size of events in a block
+        uint32_t m_high_water_count = 0; // peak number of events in a block
+        uint64_t m_overflows = 0; // number of blocks which used overflow chunks
+        uint64_t m_dropped = 0; // number of events which did not fit
+    };
+    statistics get_statistics() const noexcept;
+    void reset_statistics() noexcept;
+    uint64_t dropped() const noexcept { return m_dropped.load(std::memory_order_relaxed); }
+
+    // the memory allocated by the configuration
+    size_t memory_size() const noexcept;
+
+private:
+    void update_high_water() noexcept;
+
 private:
-    std::unique_ptr<uint8_t[]> m_buf;
+    std::unique_ptr<std::unique_ptr<uint8_t[]>[]> m_chunks;
+    uint32_t m_chunk_count = 0;
+    uint32_t m_chunk_capa = 0;
+    uint32_t m_chunk_index = 0;
     uint32_t m_fill = 0;
-    uint32_t m_capa = 0;
-    std::unique_ptr<uint32_t[]> m_ind;
+    uint32_t m_used = 0;
+    uint32_t m_pending_chunk = 0;
+    uint32_t m_pending_fill = 0;
+    uint32_t m_pending_size = 0; // the size of the reservation, or zero
+    std::unique_ptr<const clap_event_header *[]> m_ind;
+    uint32_t m_max_count = 0;
     uint32_t m_count = 0;
+    int32_t m_time_offset = 0;
+    // scratch memory of the sort: keys double-buffered, and indices
+    std::unique_ptr<uint32_t[]> m_sort_keys;
+    std::unique_ptr<const clap_event_header *[]> m_sort_ind;
+    // statistics
+    std::atomic<uint32_t> m_high_water_bytes{0};
+    std::atomic<uint32_t> m_high_water_count{0};
+    std::atomic<uint64_t> m_overflows{0};
+    std::atomic<uint64_t> m_dropped{0};
 };
 
+//------------------------------------------------------------------------------
+template <class T> T *ct_events_buffer::emplace() noexcept
+{
+    void *storage = reserve(sizeof(T));
+    if (!storage)
+        return nullptr;
+
+    T *event = new (storage) T{};
+    event->header.size = sizeof(T);
+    return event;
+}
+
 } // namespace ct
@@ -0,0 +1,22 @@
+// NOTE: this is compiled in each plugin, with the definitions of `add_v3_plugin`
+#include "ct_fixed_layout.hpp"
+
+#if !defined(CT_FIXED_LAYOUT_INPUTS)
+#   define CT_FIXED_LAYOUT_INPUTS 0
+#endif
+#if !defined(CT_FIXED_LAYOUT_OUTPUTS)
+#   define CT_FIXED_LAYOUT_OUTPUTS 0
+#endif
+#if !defined(CT_FIXED_LAYOUT_SAMPLE_SIZE)
+#   define CT_FIXED_LAYOUT_SAMPLE_SIZE 0
+#endif
+
+namespace ct {
+
+const ct_fixed_layout ct_plugin_fixed_layout{
+    CT_FIXED_LAYOUT_INPUTS,
+    CT_FIXED_LAYOUT_OUTPUTS,
+    CT_FIXED_LAYOUT_SAMPLE_SIZE,
+};
+
+} // namespace ct
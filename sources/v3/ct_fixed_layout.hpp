@@ -0,0 +1,21 @@
+#pragma once
+#include <cstdint>
+
+namespace ct {
+
+// A layout of audio ports which is known when building the plugin, and has a
+// specialized process path: one main port in each direction, with the given
+// channel counts (zero inputs for none), in the given sample size (32 or 64,
+// or zero for both). Any other configuration uses the generic process path.
+struct ct_fixed_layout {
+    uint32_t m_inputs = 0;
+    uint32_t m_outputs = 0;
+    uint32_t m_sample_size = 0;
+
+    bool enabled() const noexcept { return m_outputs > 0; }
+};
+
+// Defined in each plugin, from the options of `add_v3_plugin`
+extern const ct_fixed_layout ct_plugin_fixed_layout;
+
+} // namespace ct
@@ -2,6 +2,8 @@
 #include "ct_host_loop.hpp"
 #include "ct_component.hpp"
 #include "ct_threads.hpp"
+#include "ct_thread_pool.hpp"
+#include "ct_logger.hpp"
 #include "utility/ct_assert.hpp"
 #include "utility/ct_messages.hpp"
 #include "utility/unicode_helpers.hpp"
@@ -26,10 +28,19 @@ ct_host::ct_host(v3::object *hostcontext)
 
     // create host loop
     m_host_loop.reset(new ct_host_loop{this});
+
+    ct_logger::instance().attach();
+#if CT_TRACING
+    trace_recorder::instance().attach();
+#endif
 }
 
 ct_host::~ct_host()
 {
+#if CT_TRACING
+    trace_recorder::instance().detach();
+#endif
+    ct_logger::instance().detach();
 }
 
 //------------------------------------------------------------------------------
@@ -47,6 +58,14 @@ const void *ct_host::get_extension(const clap_host *host, const char *extension_
         return &comp->m_host->m_clap_gui;
     if (!std::strcmp(extension_id, CLAP_EXT_TIMER_SUPPORT))
         return &comp->m_host->m_clap_timer_support;
+    if (!std::strcmp(extension_id, CLAP_EXT_LOG))
+        return &comp->m_host->m_clap_log;
+    if (!std::strcmp(extension_id, CLAP_EXT_THREAD_CHECK))
+        return &comp->m_host->m_clap_thread_check;
+#if CT_HOST_THREAD_POOL
+    if (!std::strcmp(extension_id, CLAP_EXT_THREAD_POOL))
+        return &comp->m_host->m_clap_thread_pool;
+#endif
 #if CT_X11
     if (!std::strcmp(extension_id, CLAP_EXT_POSIX_FD_SUPPORT))
         return &comp->m_host->m_clap_posix_fd_support;
@@ -219,6 +238,43 @@ bool ct_host::timer_support__unregister_timer(const clap_host *host, clap_id slo
     return self->m_host_loop->unregister_timer(slot_idx);
 }
 
+//------------------------------------------------------------------------------
+void ct_host::log__log(const clap_host *host, clap_log_severity severity, const char *msg)
+{
+    ct_component *comp = (ct_component *)host->host_data;
+    const clap_plugin_descriptor *desc = comp->m_desc;
+    ct_logger::instance().log(severity, desc ? desc->name : nullptr, msg);
+}
+
+//------------------------------------------------------------------------------
+bool ct_host::thread_check__is_main_thread(const clap_host *host)
+{
+    (void)host;
+    return ct_is_main_thread();
+}
+
+bool ct_host::thread_check__is_audio_thread(const clap_host *host)
+{
+    (void)host;
+    return ct_is_audio_thread();
+}
+
+//------------------------------------------------------------------------------
+#if CT_HOST_THREAD_POOL
+bool ct_host::thread_pool__request_exec(const clap_host *host, uint32_t num_tasks)
+{
+    ct_component *comp = (ct_component *)host->host_data;
+    const clap_plugin_thread_pool *thread_pool = comp->m_ext.m_thread_pool;
+
+    // the workers run while the plugin is active, otherwise it runs the tasks
+    if (!thread_pool || !comp->m_active || !ct_is_audio_thread())
+        return false;
+
+    ct_thread_pool::instance().execute(comp->m_plug, thread_pool, num_tasks);
+    return true;
+}
+#endif
+
 //------------------------------------------------------------------------------
 #if CT_X11
 bool ct_host::posix_fd__register_fd(const clap_host *host, int fd, clap_posix_fd_flags_t flags)
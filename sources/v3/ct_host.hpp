@@ -44,6 +44,18 @@ struct ct_host {
     static bool timer_support__register_timer(const clap_host *host, uint32_t period_ms, clap_id *timer_id);
     static bool timer_support__unregister_timer(const clap_host *host, clap_id timer_id);
 
+    //--------------------------------------------------------------------------
+    static void log__log(const clap_host *host, clap_log_severity severity, const char *msg);
+
+    //--------------------------------------------------------------------------
+    static bool thread_check__is_main_thread(const clap_host *host);
+    static bool thread_check__is_audio_thread(const clap_host *host);
+
+    //--------------------------------------------------------------------------
+#if CT_HOST_THREAD_POOL
+    static bool thread_pool__request_exec(const clap_host *host, uint32_t num_tasks);
+#endif
+
     //--------------------------------------------------------------------------
 #if CT_X11
     static bool posix_fd__register_fd(const clap_host *host, int fd, clap_posix_fd_flags_t flags);
@@ -104,6 +116,24 @@ struct ct_host {
         &timer_support__unregister_timer,
     };
 
+    //--------------------------------------------------------------------------
+    const clap_host_log m_clap_log = {
+        &log__log,
+    };
+
+    //--------------------------------------------------------------------------
+    const clap_host_thread_check m_clap_thread_check = {
+        &thread_check__is_main_thread,
+        &thread_check__is_audio_thread,
+    };
+
+    //--------------------------------------------------------------------------
+#if CT_HOST_THREAD_POOL
+    const clap_host_thread_pool m_clap_thread_pool = {
+        &thread_pool__request_exec,
+    };
+#endif
+
     //--------------------------------------------------------------------------
 #if CT_X11
     const clap_host_posix_fd_support m_clap_posix_fd_support = {
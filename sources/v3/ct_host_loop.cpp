@@ -3,6 +3,8 @@
 #include "ct_component.hpp"
 #include "ct_event_handler.hpp"
 #include "ct_timer_handler.hpp"
+#include "ct_threads.hpp"
+#include "ct_live_stats.hpp"
 #include <unordered_map>
 
 #if defined(_WIN32)
@@ -82,6 +84,12 @@ static void invoke_timer_callback(ct_host_loop::timer_data *timer_data)
     ct_component *comp = (ct_component *)timer_data->m_host->m_clap_host.host_data;
     const clap_plugin *plug = comp->m_plug;
     clap_id timer_idx = timer_data->m_idx;
+    ct_thread_role_scope role{ct_thread_role_main};
+
+#if CT_LIVE_STATS
+    if (ct_live_stats_slot *stats = comp->m_stats)
+        ct_live_stats_add(stats->m_timer_callbacks, 1);
+#endif
 
     if (timer_data->m_reserved)
         comp->on_reserved_timer(timer_idx);
@@ -216,6 +224,7 @@ static void invoke_posix_fd_callback(ct_host_loop::posix_fd_data *posix_fd_data,
 {
     ct_component *comp = (ct_component *)posix_fd_data->m_host->m_clap_host.host_data;
     const clap_plugin *plug = comp->m_plug;
+    ct_thread_role_scope role{ct_thread_role_main};
 
     const clap_plugin_posix_fd_support *posix_fd_support = comp->m_ext.m_posix_fd_support;
     if (posix_fd_support)
@@ -279,6 +279,9 @@ void threaded_run_loop::background::run()
     threaded_run_loop *self = m_self;
     bool quit = false;
 
+    // this thread runs together with the host thread, with the same role
+    ct_thread_roles |= ct_thread_role_main;
+
     int message_fd = self->m_message_pipe.reader_fd();
 
     while (!quit) {
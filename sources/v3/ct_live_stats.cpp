@@ -0,0 +1,155 @@
+#include "ct_live_stats.hpp"
+#include "ct_defs.hpp"
+
+#if CT_LIVE_STATS
+#include "utility/ct_messages.hpp"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+namespace ct {
+
+ct_live_stats &ct_live_stats::instance()
+{
+    static ct_live_stats stats;
+    return stats;
+}
+
+static void reset_slot(ct_live_stats_slot &slot, const char *name)
+{
+    std::strncpy(slot.m_name, name ? name : "", ct_live_stats_name_size - 1);
+    slot.m_name[ct_live_stats_name_size - 1] = '\0';
+
+    slot.m_active.store(0, std::memory_order_relaxed);
+    slot.m_sample_rate.store(0, std::memory_order_relaxed);
+    for (std::atomic<uint64_t> *counter : {
+            &slot.m_process_calls, &slot.m_process_ns, &slot.m_process_max_ns,
+            &slot.m_blocks, &slot.m_sleeping_blocks,
+            &slot.m_events_in, &slot.m_events_out, &slot.m_events_dropped,
+            &slot.m_timer_callbacks, &slot.m_memory_bytes})
+        counter->store(0, std::memory_order_relaxed);
+}
+
+// the process which owned a slot does not exist anymore
+static bool owner_is_dead(uint32_t pid, uint32_t own_pid)
+{
+    return pid != own_pid && pid != 0 && kill((pid_t)pid, 0) == -1 && errno == ESRCH;
+}
+
+ct_live_stats_slot *ct_live_stats::claim(const char *name)
+{
+    std::lock_guard<std::mutex> lock{m_mutex};
+
+    if (!m_segment && !map_segment())
+        return nullptr;
+
+    uint32_t pid = (uint32_t)getpid();
+    ct_live_stats_slot *found = nullptr;
+
+    // a free slot, or else one which a dead process has left, whether it had
+    // finished to claim it or not; the slot is owned from the exchange of
+    // the process ID, before its state is set
+    for (ct_live_stats_slot &slot : m_segment->m_slots) {
+        uint32_t owner = 0;
+        if (slot.m_pid.compare_exchange_strong(owner, pid, std::memory_order_acquire)) {
+            found = &slot;
+            break;
+        }
+    }
+    for (uint32_t i = 0; !found && i < ct_live_stats_max_slots; ++i) {
+        ct_live_stats_slot &slot = m_segment->m_slots[i];
+        uint32_t owner = slot.m_pid.load(std::memory_order_relaxed);
+        if (owner_is_dead(owner, pid) && slot.m_pid.compare_exchange_strong(owner, pid, std::memory_order_acquire))
+            found = &slot;
+    }
+
+    if (!found) {
+        CT_WARNING("Cannot publish the live statistics, all the slots are used");
+        if (m_users == 0)
+            unmap_segment();
+        return nullptr;
+    }
+
+    found->m_state.store(ct_live_stats_slot::claiming, std::memory_order_relaxed);
+    reset_slot(*found, name);
+    found->m_state.store(ct_live_stats_slot::live, std::memory_order_release);
+    ++m_users;
+    return found;
+}
+
+void ct_live_stats::release(ct_live_stats_slot *slot)
+{
+    std::lock_guard<std::mutex> lock{m_mutex};
+
+    slot->m_active.store(0, std::memory_order_relaxed);
+    slot->m_state.store(ct_live_stats_slot::free, std::memory_order_relaxed);
+    slot->m_pid.store(0, std::memory_order_release);
+
+    if (--m_users == 0)
+        unmap_segment();
+}
+
+// the segment is left in place, for the other processes which use it; it's
+// created empty, so any process of the user may set its size and the header
+bool ct_live_stats::map_segment()
+{
+    if (m_failed)
+        return false;
+
+    char name[ct_live_stats_segment_name_size];
+    ct_live_stats_segment_name(name, sizeof(name), (uint32_t)getuid());
+
+    int fd = shm_open(name, O_RDWR|O_CREAT, 0600);
+    if (fd == -1) {
+        CT_WARNING("Cannot open the live statistics: ", std::strerror(errno));
+        m_failed = true;
+        return false;
+    }
+
+    constexpr size_t size = sizeof(ct_live_stats_segment);
+    struct stat st;
+    void *addr = MAP_FAILED;
+    int error = 0;
+    if (fstat(fd, &st) == -1 || (st.st_size == 0 && ftruncate(fd, size) == -1))
+        error = errno;
+    else if (st.st_size != 0 && (size_t)st.st_size != size)
+        error = EPROTO;
+    else if ((addr = mmap(nullptr, size, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0)) == MAP_FAILED)
+        error = errno;
+    close(fd);
+
+    ct_live_stats_segment *segment = (ct_live_stats_segment *)addr;
+    uint64_t header = 0;
+    if (!error && !segment->m_header.compare_exchange_strong(header, ct_live_stats_segment::header()) &&
+        header != ct_live_stats_segment::header()) {
+        munmap(addr, size);
+        error = EPROTO;
+    }
+
+    if (error) {
+        if (error == EPROTO) {
+            CT_WARNING("Cannot map the live statistics, the segment is of another version");
+        }
+        else {
+            CT_WARNING("Cannot map the live statistics: ", std::strerror(error));
+        }
+        m_failed = true;
+        return false;
+    }
+
+    m_segment = segment;
+    return true;
+}
+
+void ct_live_stats::unmap_segment()
+{
+    munmap(m_segment, sizeof(ct_live_stats_segment));
+    m_segment = nullptr;
+}
+
+} // namespace ct
+#endif
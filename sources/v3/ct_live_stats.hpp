@@ -0,0 +1,106 @@
+#pragma once
+#include <atomic>
+#include <mutex>
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+
+// NOTE: this header describes the shared segment for the `ct-top` tool too,
+//       so it must not depend on the rest of the wrapper
+
+namespace ct {
+
+// Name prefix of the shared memory segments, under `/dev/shm` on Linux
+#define CT_LIVE_STATS_NAME "/claptrap-stats"
+
+enum : uint32_t {
+    ct_live_stats_magic = 0x54534c43, // "CLST"
+    ct_live_stats_version = 1,
+    ct_live_stats_max_slots = 256,
+    ct_live_stats_name_size = 64,
+    ct_live_stats_segment_name_size = 48,
+};
+
+// Name of the segment of a user: each user has their own, which the others
+// cannot access
+inline void ct_live_stats_segment_name(char *name, size_t size, uint32_t uid) noexcept
+{
+    std::snprintf(name, size, CT_LIVE_STATS_NAME "-%u", (unsigned)uid);
+}
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "The counters must be lock-free to be shared between processes");
+
+// The counters of an instance, each of them written by a single thread:
+// the audio thread, except the timer callbacks and the memory, written by
+// the main thread. The durations are in nanoseconds.
+struct alignas(64) ct_live_stats_slot {
+    enum : uint32_t { free, claiming, live };
+
+    std::atomic<uint32_t> m_state{free};
+    std::atomic<uint32_t> m_pid{0}; // process which owns the slot, or 0 if it's free
+    char m_name[ct_live_stats_name_size] = {};
+
+    std::atomic<uint32_t> m_active{0};
+    std::atomic<uint32_t> m_sample_rate{0};
+    std::atomic<uint64_t> m_process_calls{0};
+    std::atomic<uint64_t> m_process_ns{0};
+    std::atomic<uint64_t> m_process_max_ns{0};
+    std::atomic<uint64_t> m_blocks{0}; // calls of the plugin, or skipped while sleeping
+    std::atomic<uint64_t> m_sleeping_blocks{0};
+    std::atomic<uint64_t> m_events_in{0};
+    std::atomic<uint64_t> m_events_out{0};
+    std::atomic<uint64_t> m_events_dropped{0};
+    std::atomic<uint64_t> m_timer_callbacks{0};
+    std::atomic<uint64_t> m_memory_bytes{0}; // buffers of the instance, not the shared ones
+};
+
+// The segment, which is zero when it's created: the first user sets the
+// header, and the slots are claimed by the instances of all processes
+struct ct_live_stats_segment {
+    std::atomic<uint64_t> m_header{0}; // magic and version
+    ct_live_stats_slot m_slots[ct_live_stats_max_slots];
+
+    static constexpr uint64_t header() noexcept { return ((uint64_t)ct_live_stats_magic << 32) | ct_live_stats_version; }
+};
+
+// [single-writer] update a counter without a read-modify-write
+inline void ct_live_stats_add(std::atomic<uint64_t> &counter, uint64_t value) noexcept
+{
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+inline void ct_live_stats_max(std::atomic<uint64_t> &counter, uint64_t value) noexcept
+{
+    if (value > counter.load(std::memory_order_relaxed))
+        counter.store(value, std::memory_order_relaxed);
+}
+
+// Publishes the live statistics of the instances in shared memory, for
+// inspection by `ct-top` while the host runs (POSIX only).
+// The segment is mapped with the first instance, and it's left in place for
+// the other processes of the user. A slot is owned by the process whose ID
+// it holds, and the slots of processes which have died are reclaimed, in
+// any state.
+class ct_live_stats {
+public:
+    static ct_live_stats &instance();
+
+    // [main-thread] claim a slot for an instance, or get null if the segment
+    // is unavailable or full
+    ct_live_stats_slot *claim(const char *name);
+    // [main-thread] release a slot returned by `claim`
+    void release(ct_live_stats_slot *slot);
+
+private:
+    ct_live_stats() = default;
+    bool map_segment();
+    void unmap_segment();
+
+private:
+    std::mutex m_mutex;
+    uint32_t m_users = 0;
+    ct_live_stats_segment *m_segment = nullptr;
+    bool m_failed = false;
+};
+
+} // namespace ct
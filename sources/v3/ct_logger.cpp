@@ -0,0 +1,240 @@
+#include "ct_logger.hpp"
+#include "utility/ct_messages.hpp"
+#include <algorithm>
+#include <string>
+#include <new>
+#include <cstring>
+
+namespace ct {
+
+// the interval at which the writer looks for messages, the producers do not
+// wake it, since it would take a lock
+static constexpr std::chrono::milliseconds writer_interval{20};
+
+static_assert((ct_log_queue_capacity & (ct_log_queue_capacity - 1)) == 0, "The log capacity must be a power of two");
+
+// a slot of the ring, its sequence tells whether it's free to write or read
+struct alignas(ct_cache_line_size) ct_logger::cell {
+    std::atomic<size_t> m_sequence{0};
+    ct_log_record m_record;
+};
+
+//------------------------------------------------------------------------------
+ct_logger &ct_logger::instance()
+{
+    static ct_logger logger;
+    return logger;
+}
+
+ct_logger::ct_logger()
+{
+    m_memory.allocate(ct_log_queue_capacity * sizeof(cell), alignof(cell), ct_buffer_memory_flags);
+    m_cells = (cell *)m_memory.data();
+    for (size_t i = 0; i < ct_log_queue_capacity; ++i) {
+        cell *c = new (&m_cells[i]) cell{};
+        c->m_sequence.store(i, std::memory_order_relaxed);
+    }
+    m_start = std::chrono::steady_clock::now();
+}
+
+ct_logger::~ct_logger()
+{
+    if (m_writer.joinable()) {
+        m_stop.store(true);
+        m_writer_wakeup.notify_all();
+        m_writer.join();
+    }
+    close_output();
+}
+
+void ct_logger::attach()
+{
+    std::lock_guard<std::mutex> lock{m_mutex};
+
+    if (m_users++ > 0)
+        return;
+
+    m_stop.store(false);
+    m_writer = std::thread{[this]() { run_writer(); }};
+}
+
+void ct_logger::detach()
+{
+    std::lock_guard<std::mutex> lock{m_mutex};
+
+    if (--m_users > 0)
+        return;
+
+    {
+        std::lock_guard<std::mutex> writer_lock{m_writer_mutex};
+        m_stop.store(true);
+    }
+    m_writer_wakeup.notify_all();
+    m_writer.join();
+}
+
+bool ct_logger::log(clap_log_severity severity, const char *source, const char *text) noexcept
+{
+    // the misbehaving severities are above the others, they are never filtered
+    if (severity < CT_LOG_LEVEL || !text)
+        return false;
+
+    // claim a slot
+    size_t pos = m_push_pos.load(std::memory_order_relaxed);
+    cell *c;
+    for (;;) {
+        c = &m_cells[pos & (ct_log_queue_capacity - 1)];
+        size_t sequence = c->m_sequence.load(std::memory_order_acquire);
+        intptr_t difference = (intptr_t)sequence - (intptr_t)pos;
+        if (difference == 0) {
+            if (m_push_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                break;
+        }
+        else if (difference < 0) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        else
+            pos = m_push_pos.load(std::memory_order_relaxed);
+    }
+
+    // fill it and publish it
+    ct_log_record &record = c->m_record;
+    record.m_severity = severity;
+    record.m_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+    size_t source_length = source ? strnlen(source, ct_log_source_size - 1) : 0;
+    if (source_length > 0)
+        std::memcpy(record.m_source, source, source_length);
+    record.m_source[source_length] = '\0';
+    size_t text_length = strnlen(text, ct_log_text_size - 1);
+    std::memcpy(record.m_text, text, text_length);
+    record.m_text[text_length] = '\0';
+    record.m_length = (uint32_t)text_length;
+    c->m_sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+bool ct_logger::pop(ct_log_record &record) noexcept
+{
+    size_t pos = m_pop_pos;
+    cell *c = &m_cells[pos & (ct_log_queue_capacity - 1)];
+    if (c->m_sequence.load(std::memory_order_acquire) != pos + 1)
+        return false;
+
+    record = c->m_record;
+    c->m_sequence.store(pos + ct_log_queue_capacity, std::memory_order_release);
+    m_pop_pos = pos + 1;
+    return true;
+}
+
+const char *ct_logger::severity_name(clap_log_severity severity) noexcept
+{
+    switch (severity) {
+    case CLAP_LOG_DEBUG: return "debug";
+    case CLAP_LOG_INFO: return "info";
+    case CLAP_LOG_WARNING: return "warning";
+    case CLAP_LOG_ERROR: return "error";
+    case CLAP_LOG_FATAL: return "fatal";
+    case CLAP_LOG_HOST_MISBEHAVING: return "host misbehaving";
+    case CLAP_LOG_PLUGIN_MISBEHAVING: return "plugin misbehaving";
+    default: return "unknown";
+    }
+}
+
+//------------------------------------------------------------------------------
+void ct_logger::run_writer()
+{
+    open_output();
+
+    std::unique_lock<std::mutex> lock{m_writer_mutex};
+    for (;;) {
+        bool stop = m_stop.load();
+        lock.unlock();
+        write_pending();
+        if (stop)
+            break;
+        lock.lock();
+        m_writer_wakeup.wait_for(lock, writer_interval, [this]() { return m_stop.load(); });
+    }
+
+    close_output();
+}
+
+void ct_logger::write_pending()
+{
+    ct_log_record record;
+    bool written = false;
+    while (pop(record)) {
+        write_record(record);
+        written = true;
+    }
+
+    uint64_t dropped = m_dropped.load(std::memory_order_relaxed);
+    if (dropped != m_reported_dropped) {
+        ct_log_record report;
+        report.m_severity = CLAP_LOG_WARNING;
+        report.m_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+        std::snprintf(report.m_text, sizeof(report.m_text), "%llu messages dropped, the log is full", (unsigned long long)(dropped - m_reported_dropped));
+        report.m_length = (uint32_t)std::strlen(report.m_text);
+        write_record(report);
+        m_reported_dropped = dropped;
+        written = true;
+    }
+
+    if (written && m_output)
+        std::fflush(m_output);
+}
+
+void ct_logger::write_record(const ct_log_record &record)
+{
+    if (!m_output)
+        return;
+
+    int count;
+    if (record.m_source[0] != '\0')
+        count = std::fprintf(m_output, CT_MESSAGE_PREFIX "%.3f [%s] %s: %s\n", record.m_time, record.m_source, severity_name(record.m_severity), record.m_text);
+    else
+        count = std::fprintf(m_output, CT_MESSAGE_PREFIX "%.3f %s: %s\n", record.m_time, severity_name(record.m_severity), record.m_text);
+    m_output_size += (size_t)std::max(count, 0);
+
+    if (m_output != stderr && m_output_size >= ct_log_file_max_size)
+        rotate_output();
+}
+
+void ct_logger::open_output()
+{
+    const char *path = CT_LOG_FILE;
+    m_output = stderr;
+    m_output_size = 0;
+
+    if (path[0] != '\0') {
+        if (std::FILE *file = std::fopen(path, "a")) {
+            std::fseek(file, 0, SEEK_END);
+            m_output = file;
+            m_output_size = (size_t)std::max(std::ftell(file), 0L);
+        }
+        else
+            CT_WARNING("Cannot open the log file: ", path);
+    }
+}
+
+void ct_logger::close_output()
+{
+    if (m_output && m_output != stderr)
+        std::fclose(m_output);
+    m_output = nullptr;
+}
+
+// keep the previous file as a backup, and start another
+void ct_logger::rotate_output()
+{
+    const char *path = CT_LOG_FILE;
+    std::string backup = std::string{path} + ".1";
+
+    close_output();
+    std::remove(backup.c_str());
+    std::rename(path, backup.c_str());
+    open_output();
+}
+
+} // namespace ct
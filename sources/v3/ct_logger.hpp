@@ -0,0 +1,80 @@
+#pragma once
+#include "ct_defs.hpp"
+#include "utility/ct_rt_memory.hpp"
+#include <clap/clap.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+
+namespace ct {
+
+// A message of the log, with the text truncated to fit
+struct ct_log_record {
+    clap_log_severity m_severity = CLAP_LOG_INFO;
+    uint32_t m_length = 0;
+    double m_time = 0;
+    char m_source[ct_log_source_size] = {};
+    char m_text[ct_log_text_size] = {};
+};
+
+// The logger of the wrapper, which any thread can write to, including the
+// audio thread: the messages go into a preallocated ring without locking nor
+// allocating, and a background thread writes them out.
+// - the output is the standard error, or the file `CT_LOG_FILE`, which is
+//   rotated when it reaches `ct_log_file_max_size`
+// - the messages under `CT_LOG_LEVEL` are discarded
+// - the messages are dropped when the ring is full, and counted
+class ct_logger {
+public:
+    static ct_logger &instance();
+
+    // [main-thread] register an instance, starting the writer with the first
+    void attach();
+    // [main-thread] unregister an instance, stopping the writer with the last,
+    // after it writes the pending messages
+    void detach();
+
+    // [thread-safe] log a message, without blocking
+    // returns false if the message is dropped
+    bool log(clap_log_severity severity, const char *source, const char *text) noexcept;
+
+    static const char *severity_name(clap_log_severity severity) noexcept;
+
+private:
+    ct_logger();
+    ~ct_logger();
+
+    struct alignas(ct_cache_line_size) cell;
+    bool pop(ct_log_record &record) noexcept;
+    void run_writer();
+    void write_pending();
+    void write_record(const ct_log_record &record);
+    void open_output();
+    void close_output();
+    void rotate_output();
+
+private:
+    std::mutex m_mutex;
+    uint32_t m_users = 0;
+    std::thread m_writer;
+    std::atomic<bool> m_stop{false};
+    std::mutex m_writer_mutex;
+    std::condition_variable m_writer_wakeup;
+
+    rt_memory m_memory;
+    cell *m_cells = nullptr;
+    alignas(ct_cache_line_size) std::atomic<size_t> m_push_pos{0};
+    alignas(ct_cache_line_size) size_t m_pop_pos = 0;
+    std::atomic<uint64_t> m_dropped{0};
+    uint64_t m_reported_dropped = 0;
+
+    std::chrono::steady_clock::time_point m_start;
+    std::FILE *m_output = nullptr;
+    size_t m_output_size = 0;
+};
+
+} // namespace ct
@@ -0,0 +1,20 @@
+#include "ct_param_feedback.hpp"
+
+namespace ct {
+
+void ct_param_feedback::resize(uint32_t count)
+{
+    uint32_t word_count = (count + 63) / 64;
+
+    m_values.reset(new std::atomic<uint64_t>[count]);
+    m_dirty.reset(new std::atomic<uint64_t>[word_count]);
+    for (uint32_t i = 0; i < count; ++i)
+        m_values[i].store(0, std::memory_order_relaxed);
+    for (uint32_t w = 0; w < word_count; ++w)
+        m_dirty[w].store(0, std::memory_order_relaxed);
+
+    m_count = count;
+    m_word_count = word_count;
+}
+
+} // namespace ct
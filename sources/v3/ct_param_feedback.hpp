@@ -0,0 +1,62 @@
+#pragma once
+#include <memory>
+#include <atomic>
+#include <cstring>
+#include <cstdint>
+
+namespace ct {
+
+// Transmits the parameter values of the plugin, from audio to main thread.
+// The audio thread stores the latest value of a parameter in its slot, and
+// marks the slot in a bitmap; the main thread collects the marked slots.
+// Both sides are wait-free, and only the latest value of a slot is kept.
+class ct_param_feedback {
+public:
+    // NOTE: not thread-safe, must not be called while processing
+    void resize(uint32_t count);
+    uint32_t size() const noexcept { return m_count; }
+
+    // [audio-thread]
+    void publish(uint32_t index, double value) noexcept;
+
+    // [main-thread] calls `fn(index, value)` for every updated slot
+    template <class Fn> void collect(Fn &&fn);
+
+private:
+    uint32_t m_count = 0;
+    uint32_t m_word_count = 0;
+    std::unique_ptr<std::atomic<uint64_t>[]> m_values;
+    std::unique_ptr<std::atomic<uint64_t>[]> m_dirty;
+};
+
+//------------------------------------------------------------------------------
+inline void ct_param_feedback::publish(uint32_t index, double value) noexcept
+{
+    if (index >= m_count)
+        return;
+
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(double));
+    m_values[index].store(bits, std::memory_order_relaxed);
+    m_dirty[index / 64].fetch_or(uint64_t{1} << (index % 64), std::memory_order_release);
+}
+
+template <class Fn> void ct_param_feedback::collect(Fn &&fn)
+{
+    for (uint32_t w = 0; w < m_word_count; ++w) {
+        if (m_dirty[w].load(std::memory_order_relaxed) == 0)
+            continue;
+        uint64_t dirty = m_dirty[w].exchange(0, std::memory_order_acquire);
+        for (uint32_t b = 0; dirty != 0; ++b, dirty >>= 1) {
+            if ((dirty & 1) == 0)
+                continue;
+            uint32_t index = w * 64 + b;
+            uint64_t bits = m_values[index].load(std::memory_order_relaxed);
+            double value;
+            std::memcpy(&value, &bits, sizeof(double));
+            fn(index, value);
+        }
+    }
+}
+
+} // namespace ct
@@ -1,6 +1,7 @@
 #include "ct_plug_view.hpp"
 #include "ct_plug_view_content_scale.hpp"
 #include "ct_component.hpp"
+#include "ct_threads.hpp"
 #include "clap_helpers.hpp"
 #include "utility/ct_assert.hpp"
 #include <algorithm>
@@ -79,6 +80,8 @@ v3_result V3_API ct_plug_view::is_platform_type_supported(void *self_, const cha
 {
     LOG_PLUGIN_SELF_CALL(self_);
 
+    ct_thread_role_scope role{ct_thread_role_main};
+
     ct_plug_view *self = (ct_plug_view *)self_;
     ct_component *comp = self->m_comp;
     const clap_plugin *plug = comp->m_plug;
@@ -119,6 +122,8 @@ v3_result V3_API ct_plug_view::attached(void *self_, void *parent, const char *p
 {
     LOG_PLUGIN_SELF_CALL(self_);
 
+    ct_thread_role_scope role{ct_thread_role_main};
+
     ct_plug_view *self = (ct_plug_view *)self_;
     ct_component *comp = self->m_comp;
     const clap_plugin *plug = comp->m_plug;
@@ -161,6 +166,8 @@ v3_result V3_API ct_plug_view::removed(void *self_)
 {
     LOG_PLUGIN_SELF_CALL(self_);
 
+    ct_thread_role_scope role{ct_thread_role_main};
+
     ct_plug_view *self = (ct_plug_view *)self_;
     ct_component *comp = self->m_comp;
     const clap_plugin *plug = comp->m_plug;
@@ -218,6 +225,8 @@ v3_result V3_API ct_plug_view::get_size(void *self_, v3_view_rect *rect)
 {
     LOG_PLUGIN_SELF_CALL(self_);
 
+    ct_thread_role_scope role{ct_thread_role_main};
+
     ct_plug_view *self = (ct_plug_view *)self_;
     ct_component *comp = self->m_comp;
     const clap_plugin *plug = comp->m_plug;
@@ -259,6 +268,8 @@ v3_result V3_API ct_plug_view::on_size(void *self_, v3_view_rect *rect)
 {
     LOG_PLUGIN_SELF_CALL(self_);
 
+    ct_thread_role_scope role{ct_thread_role_main};
+
     ct_plug_view *self = (ct_plug_view *)self_;
     ct_component *comp = self->m_comp;
     const clap_plugin *plug = comp->m_plug;
@@ -304,6 +315,8 @@ v3_result V3_API ct_plug_view::can_resize(void *self_)
 {
     LOG_PLUGIN_SELF_CALL(self_);
 
+    ct_thread_role_scope role{ct_thread_role_main};
+
     ct_plug_view *self = (ct_plug_view *)self_;
     ct_component *comp = self->m_comp;
     const clap_plugin *plug = comp->m_plug;
@@ -319,6 +332,8 @@ v3_result V3_API ct_plug_view::check_size_constraint(void *self_, v3_view_rect *
 {
     LOG_PLUGIN_SELF_CALL(self_);
 
+    ct_thread_role_scope role{ct_thread_role_main};
+
     ct_plug_view *self = (ct_plug_view *)self_;
     ct_component *comp = self->m_comp;
     const clap_plugin *plug = comp->m_plug;
@@ -1,6 +1,7 @@
 #include "ct_plug_view_content_scale.hpp"
 #include "ct_plug_view.hpp"
 #include "ct_component.hpp"
+#include "ct_threads.hpp"
 #include "utility/ct_assert.hpp"
 
 namespace ct {
@@ -38,6 +39,8 @@ v3_result V3_API ct_plug_view_content_scale::set_content_scale_factor(void *self
 {
     LOG_PLUGIN_SELF_CALL(self_);
 
+    ct_thread_role_scope role{ct_thread_role_main};
+
     ct_plug_view_content_scale *self = (ct_plug_view_content_scale *)self_;
     ct_plug_view *view = self->m_view;
     ct_component *comp = view->m_comp;
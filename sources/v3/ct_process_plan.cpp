@@ -0,0 +1,207 @@
+#include "ct_process_plan.hpp"
+#include "utility/ct_assert.hpp"
+
+namespace ct {
+
+namespace {
+struct direction_layout {
+    size_t m_routes = 0;
+    size_t m_active_ports = 0;
+    size_t m_buffers32 = 0;
+    size_t m_buffers64 = 0;
+    size_t m_slots32 = 0;
+    size_t m_slots64 = 0;
+};
+} // namespace
+
+static size_t pad_to_alignment(size_t size)
+{
+    constexpr size_t align = ct_buffer_alignment;
+    return (size + (align - 1)) & ~(align - 1);
+}
+
+static bool is_port_active(const ct_process_plan::port_list &list, uint32_t p_idx)
+{
+    return p_idx >= list.m_active.size() || list.m_active[p_idx];
+}
+
+static uint32_t count_active_ports(const ct_process_plan::port_list &list)
+{
+    uint32_t count = 0;
+    for (uint32_t p_idx = 0; p_idx < (uint32_t)list.m_ports.size(); ++p_idx)
+        count += is_port_active(list, p_idx);
+    return count;
+}
+
+static uint32_t count_channels(const ct_process_plan::port_list &list, bool only_active)
+{
+    uint32_t count = 0;
+    for (uint32_t p_idx = 0; p_idx < (uint32_t)list.m_ports.size(); ++p_idx) {
+        if (!only_active || is_port_active(list, p_idx))
+            count += list.m_ports[p_idx].channel_count;
+    }
+    return count;
+}
+
+static void fill_direction(ct_process_plan::direction_t &dir, uint8_t *base, const direction_layout &layout, const ct_process_plan::port_list &list, bool is_input, void *unused_buffer, uint32_t *unused_slots)
+{
+    uint32_t num_ports = (uint32_t)list.m_ports.size();
+    uint32_t num_routes = count_channels(list, true);
+
+    dir.m_routes = nonstd::span<ct_process_route>{(ct_process_route *)(base + layout.m_routes), num_routes};
+    dir.m_active_ports = nonstd::span<uint32_t>{(uint32_t *)(base + layout.m_active_ports), count_active_ports(list)};
+    dir.m_port_count = num_ports;
+    dir.m_buffers32 = (clap_audio_buffer *)(base + layout.m_buffers32);
+    dir.m_buffers64 = (clap_audio_buffer *)(base + layout.m_buffers64);
+    dir.m_slots32 = (float **)(base + layout.m_slots32);
+    dir.m_slots64 = (double **)(base + layout.m_slots64);
+
+    uint32_t r_idx = 0;
+    uint32_t a_idx = 0;
+    uint32_t slot = 0;
+    uint32_t u_idx = 0;
+    for (uint32_t p_idx = 0; p_idx < num_ports; ++p_idx) {
+        const ct_clap_port_info &port = list.m_ports[p_idx];
+        uint32_t channel_count = port.channel_count;
+        bool active = is_port_active(list, p_idx);
+
+        clap_audio_buffer port_data32{};
+        port_data32.data32 = dir.m_slots32 + slot;
+        port_data32.channel_count = channel_count;
+
+        clap_audio_buffer port_data64{};
+        port_data64.data64 = dir.m_slots64 + slot;
+        port_data64.channel_count = channel_count;
+
+        if (active)
+            dir.m_active_ports[a_idx++] = p_idx;
+        else {
+            // the plugin still requires buffers, filled with silence
+            for (uint32_t c_idx = 0; c_idx < channel_count; ++c_idx) {
+                dir.m_slots32[slot + c_idx] = (float *)unused_buffer;
+                dir.m_slots64[slot + c_idx] = (double *)unused_buffer;
+                if (unused_slots)
+                    unused_slots[u_idx++] = slot + c_idx;
+            }
+            if (is_input) {
+                uint64_t mask = (channel_count < 64) ? ((uint64_t{1} << channel_count) - 1) : ~uint64_t{0};
+                port_data32.constant_mask = mask;
+                port_data64.constant_mask = mask;
+            }
+        }
+
+        dir.m_buffers32[p_idx] = port_data32;
+        dir.m_buffers64[p_idx] = port_data64;
+
+        for (uint32_t c_idx = 0; active && c_idx < channel_count; ++c_idx) {
+            uint32_t c_mapped = port.mapping.map_to_clap(c_idx);
+            CT_ASSERT(c_mapped < channel_count);
+
+            ct_process_route route;
+            route.m_slot = slot + c_mapped;
+            route.m_v3_bus = (uint16_t)p_idx;
+            route.m_v3_channel = (uint16_t)c_idx;
+            route.m_clap_port = (uint16_t)p_idx;
+            route.m_clap_channel = (uint16_t)c_mapped;
+            if (port.in_place_pair_index != ct_clap_port_info::no_port)
+                route.m_pair_port = (uint16_t)port.in_place_pair_index;
+            dir.m_routes[r_idx++] = route;
+        }
+
+        slot += channel_count;
+    }
+}
+
+void ct_process_plan::build(const port_list &inputs, const port_list &outputs, uint32_t max_frames, bool host_64bit, bool plugin_64bit)
+{
+    clear();
+
+    // compute the layout, with every table and buffer aligned for vectors,
+    // and starting on its own cache line
+    size_t total_size = 0;
+    auto reserve = [&total_size](size_t size) -> size_t {
+        size_t offset = total_size;
+        total_size += pad_to_alignment(size);
+        return offset;
+    };
+    auto reserve_direction = [&reserve](const port_list &list) -> direction_layout {
+        uint32_t num_ports = (uint32_t)list.m_ports.size();
+        uint32_t num_channels = count_channels(list, false);
+        direction_layout layout;
+        layout.m_routes = reserve(count_channels(list, true) * sizeof(ct_process_route));
+        layout.m_active_ports = reserve(count_active_ports(list) * sizeof(uint32_t));
+        layout.m_buffers32 = reserve(num_ports * sizeof(clap_audio_buffer));
+        layout.m_buffers64 = reserve(num_ports * sizeof(clap_audio_buffer));
+        layout.m_slots32 = reserve(num_channels * sizeof(float *));
+        layout.m_slots64 = reserve(num_channels * sizeof(double *));
+        return layout;
+    };
+
+    direction_layout input_layout = reserve_direction(inputs);
+    direction_layout output_layout = reserve_direction(outputs);
+    uint32_t num_trash_slots = count_channels(outputs, false) - count_channels(outputs, true);
+    size_t trash_slots_offset = reserve(num_trash_slots * sizeof(uint32_t));
+
+    CT_ASSERT(host_64bit || !plugin_64bit);
+    bool converts = host_64bit != plugin_64bit;
+
+    // buffers are large enough for either precision
+    // the scratch starts with the trash, then has the copies and conversions
+    size_t float_size = host_64bit ? sizeof(double) : sizeof(float);
+    size_t copy_stride = pad_to_alignment(max_frames * float_size);
+    size_t copy_offset = copy_stride;
+    size_t convert_offset = copy_offset + count_channels(inputs, true) * copy_stride;
+    size_t scratch_size = convert_offset + (converts ? (count_channels(outputs, true) * copy_stride) : 0);
+
+    // allocate, with the pages faulted in before the audio thread runs
+    m_memory.allocate(total_size, ct_buffer_alignment, ct_buffer_memory_flags);
+    uint8_t *base = m_memory.data();
+    m_zero = ct_shared_buffers::instance().attach(copy_stride, scratch_size);
+
+    // fill the tables, the outputs are bound to the trash for each block
+    m_zero_buffer = m_zero->data();
+    m_trash_slots = nonstd::span<uint32_t>{(uint32_t *)(base + trash_slots_offset), num_trash_slots};
+    fill_direction(m_inputs, base, input_layout, inputs, true, m_zero_buffer, nullptr);
+    fill_direction(m_outputs, base, output_layout, outputs, false, nullptr, m_trash_slots.data());
+    m_copy_offset = copy_offset;
+    m_convert_offset = converts ? convert_offset : 0;
+    m_copy_stride = copy_stride;
+    m_zero_size = copy_stride;
+    m_scratch_size = scratch_size;
+    m_max_frames = max_frames;
+    m_plugin_64bit = plugin_64bit;
+    m_converts = converts;
+}
+
+void ct_process_plan::bind_scratch(uint8_t *scratch) noexcept
+{
+    m_scratch = scratch;
+    for (uint32_t slot : m_trash_slots) {
+        m_outputs.m_slots32[slot] = (float *)scratch;
+        m_outputs.m_slots64[slot] = (double *)scratch;
+    }
+}
+
+void ct_process_plan::clear()
+{
+    if (m_zero) {
+        m_zero.reset();
+        ct_shared_buffers::instance().detach(m_zero_size, m_scratch_size);
+    }
+    m_inputs = direction_t{};
+    m_outputs = direction_t{};
+    m_trash_slots = nonstd::span<uint32_t>{};
+    m_zero_buffer = nullptr;
+    m_scratch = nullptr;
+    m_copy_offset = 0;
+    m_convert_offset = 0;
+    m_copy_stride = 0;
+    m_zero_size = 0;
+    m_scratch_size = 0;
+    m_max_frames = 0;
+    m_plugin_64bit = false;
+    m_converts = false;
+    m_memory.reset();
+}
+
+} // namespace ct
@@ -0,0 +1,114 @@
+#pragma once
+#include "ct_defs.hpp"
+#include "clap_helpers.hpp"
+#include "ct_shared_buffers.hpp"
+#include "utility/ct_rt_memory.hpp"
+#include "libs/span.hpp"
+#include <clap/clap.h>
+#include <memory>
+#include <cstdint>
+
+namespace ct {
+
+// A connection between a channel of VST3 bus, and a channel of CLAP port
+struct ct_process_route {
+    enum : uint16_t { no_port = 0xffff };
+
+    uint32_t m_slot = 0; // index of the channel pointer in the CLAP slots
+    uint16_t m_v3_bus = 0;
+    uint16_t m_v3_channel = 0; // also the bit in `channel_silence_bitset`
+    uint16_t m_clap_port = 0;
+    uint16_t m_clap_channel = 0; // also the bit in `constant_mask`
+    uint16_t m_pair_port = no_port; // port of the in-place pair, if any
+    uint16_t m_reserved = 0;
+};
+
+static_assert(sizeof(ct_process_route) == 16, "Routes should be packed");
+
+// The precomputed layout of audio buffers, for a given configuration of ports.
+// It's built once when the plugin activates, and the audio callback just runs
+// through the flat tables, to fill the preallocated CLAP structures.
+// The buffers of silence and scratch are shared with the other instances.
+class ct_process_plan {
+public:
+    struct port_list {
+        nonstd::span<const ct_clap_port_info> m_ports;
+        nonstd::span<const uint8_t> m_active; // active flags, ports beyond are active
+    };
+
+    // NOTE: the plugin processes in double precision only if the host does,
+    //       otherwise the samples are converted to and from single precision
+    void build(const port_list &inputs, const port_list &outputs, uint32_t max_frames, bool host_64bit, bool plugin_64bit);
+    void clear();
+    bool empty() const noexcept { return !m_memory; }
+    size_t memory_size() const noexcept { return m_memory.size(); }
+
+    // [audio-thread] set the scratch memory for the current block, which has
+    // at least `scratch_size()` bytes, and point the inactive outputs to it
+    void bind_scratch(uint8_t *scratch) noexcept;
+    size_t scratch_size() const noexcept { return m_scratch_size; }
+
+    uint32_t max_frames() const noexcept { return m_max_frames; }
+    bool plugin_64bit() const noexcept { return m_plugin_64bit; }
+    bool converts() const noexcept { return m_converts; }
+
+    // NOTE: the channels of inactive ports do not have routes, and their
+    //       buffers permanently point to zero (inputs) or trash (outputs)
+    struct direction_t {
+        nonstd::span<ct_process_route> m_routes;
+        nonstd::span<uint32_t> m_active_ports;
+        uint32_t m_port_count = 0;
+        clap_audio_buffer *m_buffers32 = nullptr;
+        clap_audio_buffer *m_buffers64 = nullptr;
+        float **m_slots32 = nullptr;
+        double **m_slots64 = nullptr;
+
+        template <class Real> clap_audio_buffer *buffers() const noexcept;
+        template <class Real> Real **slots() const noexcept;
+    };
+
+    const direction_t &inputs() const noexcept { return m_inputs; }
+    const direction_t &outputs() const noexcept { return m_outputs; }
+
+    // a scratch buffer for the input route, large enough for the maximum frames
+    template <class Real> Real *copy_buffer(uint32_t route_index) const noexcept
+    {
+        return (Real *)(m_scratch + m_copy_offset + route_index * m_copy_stride);
+    }
+
+    // a scratch buffer for the output route, if the plan converts samples
+    template <class Real> Real *convert_buffer(uint32_t route_index) const noexcept
+    {
+        return (Real *)(m_scratch + m_convert_offset + route_index * m_copy_stride);
+    }
+
+    // a buffer of silence, for inputs which the host does not provide
+    template <class Real> Real *zero_buffer() const noexcept { return (Real *)m_zero_buffer; }
+    // a buffer to discard outputs which the host does not provide
+    template <class Real> Real *trash_buffer() const noexcept { return (Real *)m_scratch; }
+
+private:
+    direction_t m_inputs;
+    direction_t m_outputs;
+    nonstd::span<uint32_t> m_trash_slots; // output slots of inactive ports
+    uint8_t *m_zero_buffer = nullptr;
+    uint8_t *m_scratch = nullptr;
+    size_t m_copy_offset = 0;
+    size_t m_convert_offset = 0;
+    size_t m_copy_stride = 0;
+    size_t m_zero_size = 0;
+    size_t m_scratch_size = 0;
+    std::shared_ptr<const rt_memory> m_zero;
+    uint32_t m_max_frames = 0;
+    bool m_plugin_64bit = false;
+    bool m_converts = false;
+    rt_memory m_memory;
+};
+
+//------------------------------------------------------------------------------
+template <> inline clap_audio_buffer *ct_process_plan::direction_t::buffers<float>() const noexcept { return m_buffers32; }
+template <> inline clap_audio_buffer *ct_process_plan::direction_t::buffers<double>() const noexcept { return m_buffers64; }
+template <> inline float **ct_process_plan::direction_t::slots<float>() const noexcept { return m_slots32; }
+template <> inline double **ct_process_plan::direction_t::slots<double>() const noexcept { return m_slots64; }
+
+} // namespace ct
@@ -0,0 +1,119 @@
+#include "ct_process_timing.hpp"
+#include <chrono>
+#include <thread>
+
+namespace ct {
+
+static uint32_t bucket_index(uint64_t ns) noexcept
+{
+    uint32_t index = 0;
+#if defined(__GNUC__)
+    if (ns > 1)
+        index = 63 - (uint32_t)__builtin_clzll(ns);
+#else
+    while (ns >>= 1)
+        ++index;
+#endif
+    return (index < ct_timing_buckets) ? index : (ct_timing_buckets - 1);
+}
+
+uint64_t ct_process_timing::now() noexcept
+{
+    auto time = std::chrono::steady_clock::now().time_since_epoch();
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(time).count();
+}
+
+void ct_process_timing::configure(double sample_rate) noexcept
+{
+    m_ns_per_frame = (sample_rate > 0) ? (1e9 / sample_rate) : 0;
+    m_plugin_ns = 0;
+    m_blocks.store(0, std::memory_order_relaxed);
+    m_offline_blocks.store(0, std::memory_order_relaxed);
+    m_over_threshold.store(0, std::memory_order_relaxed);
+    m_over_budget.store(0, std::memory_order_relaxed);
+    m_max_load.store(0, std::memory_order_relaxed);
+    clear(m_wrapper);
+    clear(m_plugin);
+}
+
+double ct_process_timing::record(uint64_t total_ns, uint32_t nframes, bool realtime) noexcept
+{
+    uint64_t plugin_ns = (m_plugin_ns < total_ns) ? m_plugin_ns : total_ns;
+    m_plugin_ns = 0;
+
+    if (!realtime) {
+        m_offline_blocks.store(m_offline_blocks.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return 0;
+    }
+
+    double budget_ns = nframes * m_ns_per_frame;
+    double load = (budget_ns > 0) ? (total_ns / budget_ns) : 0;
+
+    // the writer is single, the values need not be modified atomically
+    uint32_t sequence = m_sequence.load(std::memory_order_relaxed);
+    m_sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    m_blocks.store(m_blocks.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    if (load > CT_DEADLINE_THRESHOLD * 1e-2)
+        m_over_threshold.store(m_over_threshold.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    if (load > 1.0)
+        m_over_budget.store(m_over_budget.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    if (load > m_max_load.load(std::memory_order_relaxed))
+        m_max_load.store(load, std::memory_order_relaxed);
+    add(m_wrapper, total_ns - plugin_ns);
+    add(m_plugin, plugin_ns);
+
+    m_sequence.store(sequence + 2, std::memory_order_release);
+    return load;
+}
+
+void ct_process_timing::snapshot(ct_process_timing_snapshot &snapshot) const noexcept
+{
+    for (;;) {
+        uint32_t sequence = m_sequence.load(std::memory_order_acquire);
+        if (sequence & 1) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        snapshot.m_blocks = m_blocks.load(std::memory_order_relaxed);
+        snapshot.m_offline_blocks = m_offline_blocks.load(std::memory_order_relaxed);
+        snapshot.m_over_threshold = m_over_threshold.load(std::memory_order_relaxed);
+        snapshot.m_over_budget = m_over_budget.load(std::memory_order_relaxed);
+        snapshot.m_max_load = m_max_load.load(std::memory_order_relaxed);
+        read(m_wrapper, snapshot.m_wrapper);
+        read(m_plugin, snapshot.m_plugin);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (m_sequence.load(std::memory_order_relaxed) == sequence)
+            break;
+    }
+}
+
+void ct_process_timing::add(histogram &h, uint64_t ns) noexcept
+{
+    std::atomic<uint64_t> &bucket = h.m_buckets[bucket_index(ns)];
+    bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    h.m_total_ns.store(h.m_total_ns.load(std::memory_order_relaxed) + ns, std::memory_order_relaxed);
+    if (ns > h.m_max_ns.load(std::memory_order_relaxed))
+        h.m_max_ns.store(ns, std::memory_order_relaxed);
+}
+
+void ct_process_timing::read(const histogram &h, ct_timing_histogram &out) noexcept
+{
+    for (uint32_t i = 0; i < ct_timing_buckets; ++i)
+        out.m_buckets[i] = h.m_buckets[i].load(std::memory_order_relaxed);
+    out.m_total_ns = h.m_total_ns.load(std::memory_order_relaxed);
+    out.m_max_ns = h.m_max_ns.load(std::memory_order_relaxed);
+}
+
+void ct_process_timing::clear(histogram &h) noexcept
+{
+    for (std::atomic<uint64_t> &bucket : h.m_buckets)
+        bucket.store(0, std::memory_order_relaxed);
+    h.m_total_ns.store(0, std::memory_order_relaxed);
+    h.m_max_ns.store(0, std::memory_order_relaxed);
+}
+
+} // namespace ct
@@ -0,0 +1,74 @@
+#pragma once
+#include "ct_defs.hpp"
+#include <atomic>
+#include <cstdint>
+
+namespace ct {
+
+// Durations on a log scale: the bucket `i` counts the durations from 2^i to
+// 2^(i+1) nanoseconds, and the last one counts anything longer
+struct ct_timing_histogram {
+    uint64_t m_buckets[ct_timing_buckets] = {};
+    uint64_t m_total_ns = 0;
+    uint64_t m_max_ns = 0;
+};
+
+struct ct_process_timing_snapshot {
+    uint64_t m_blocks = 0; // in real time
+    uint64_t m_offline_blocks = 0; // not timed, having no deadline
+    uint64_t m_over_threshold = 0; // above `CT_DEADLINE_THRESHOLD` of the budget
+    uint64_t m_over_budget = 0; // deadline missed
+    double m_max_load = 0; // highest fraction of the budget
+    ct_timing_histogram m_wrapper;
+    ct_timing_histogram m_plugin;
+};
+
+// Times the `process` calls of an instance, separating the plugin from the
+// wrapper, against the real-time budget of the block.
+// The offline and prefetch calls have no deadline, and are only counted.
+// The audio thread is the single writer, and it never waits; the main thread
+// takes consistent snapshots, retrying while a block is being recorded.
+class ct_process_timing {
+public:
+    // [main-thread] reset, with the sample rate which gives the budget
+    void configure(double sample_rate) noexcept;
+
+    static uint64_t now() noexcept;
+
+    // [audio-thread] accumulate the time of the plugin, in the current call
+    void add_plugin_time(uint64_t ns) noexcept { m_plugin_ns += ns; }
+    // [audio-thread] record the call, which processed the frames in the time
+    // given, and return its fraction of the budget, or 0 if not in real time
+    double record(uint64_t total_ns, uint32_t nframes, bool realtime) noexcept;
+    // [audio-thread] the deadlines missed
+    uint64_t over_budget() const noexcept { return m_over_budget.load(std::memory_order_relaxed); }
+
+    // [thread-safe]
+    void snapshot(ct_process_timing_snapshot &snapshot) const noexcept;
+
+private:
+    struct histogram {
+        std::atomic<uint64_t> m_buckets[ct_timing_buckets] = {};
+        std::atomic<uint64_t> m_total_ns{0};
+        std::atomic<uint64_t> m_max_ns{0};
+    };
+
+    static void add(histogram &h, uint64_t ns) noexcept;
+    static void read(const histogram &h, ct_timing_histogram &out) noexcept;
+    static void clear(histogram &h) noexcept;
+
+private:
+    double m_ns_per_frame = 0;
+    uint64_t m_plugin_ns = 0;
+
+    std::atomic<uint32_t> m_sequence{0}; // odd while recording
+    std::atomic<uint64_t> m_blocks{0};
+    std::atomic<uint64_t> m_offline_blocks{0};
+    std::atomic<uint64_t> m_over_threshold{0};
+    std::atomic<uint64_t> m_over_budget{0};
+    std::atomic<double> m_max_load{0};
+    histogram m_wrapper;
+    histogram m_plugin;
+};
+
+} // namespace ct
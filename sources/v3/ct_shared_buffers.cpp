@@ -0,0 +1,125 @@
+#include "ct_shared_buffers.hpp"
+#include "ct_threads.hpp"
+#include "utility/ct_assert.hpp"
+#include "utility/ct_messages.hpp"
+#include <algorithm>
+#include <thread>
+
+namespace ct {
+
+ct_shared_buffers &ct_shared_buffers::instance()
+{
+    static ct_shared_buffers shared;
+    return shared;
+}
+
+std::shared_ptr<const rt_memory> ct_shared_buffers::attach(size_t zero_size, size_t scratch_size)
+{
+    CT_ASSERT(ct_is_main_thread());
+
+    std::lock_guard<std::mutex> lock{m_mutex};
+
+    // the zero region, replaced if too small
+    std::shared_ptr<rt_memory> zero = m_zero.lock();
+    if (!zero || zero->size() < zero_size) {
+        std::shared_ptr<rt_memory> region = std::make_shared<rt_memory>();
+        region->allocate(std::max(zero_size, zero ? zero->size() : 0), ct_buffer_alignment, ct_buffer_memory_flags | rt_memory::read_only);
+        m_zero = region;
+        zero = std::move(region);
+    }
+
+    ++m_users;
+    m_unshared_size += zero_size + scratch_size;
+
+    // an arena for each instance, so that the instances which process at the
+    // same time always find one; the new ones are added first, to be free for
+    // the others while the previous ones are enlarged
+    uint32_t arena_count = m_arena_count.load(std::memory_order_relaxed);
+    size_t previous_size = m_arena_size;
+    m_arena_size = std::max(m_arena_size, scratch_size);
+    uint32_t target_count = std::min(m_users, (uint32_t)ct_scratch_max_arenas);
+    for (uint32_t i = arena_count; i < target_count; ++i)
+        add_arena();
+
+    // the previous arenas, which are enlarged if too small
+    // an arena in use by an audio thread is waited for, since it's short
+    if (previous_size < m_arena_size) {
+        for (uint32_t i = 0; i < arena_count; ++i) {
+            ct_scratch_arena *arena = m_arenas[i].get();
+            while (arena->m_busy.exchange(true, std::memory_order_acquire))
+                std::this_thread::yield();
+            rt_memory memory;
+            memory.allocate(m_arena_size, ct_buffer_alignment, ct_buffer_memory_flags);
+            arena->m_memory = std::move(memory);
+            arena->m_busy.store(false, std::memory_order_release);
+        }
+    }
+
+    return zero;
+}
+
+void ct_shared_buffers::detach(size_t zero_size, size_t scratch_size)
+{
+    CT_ASSERT(ct_is_main_thread());
+
+    std::lock_guard<std::mutex> lock{m_mutex};
+
+    --m_users;
+    m_unshared_size -= zero_size + scratch_size;
+
+    // the arenas are kept as long as there are instances, which may need them
+    if (m_users == 0) {
+        uint32_t arena_count = m_arena_count.exchange(0, std::memory_order_relaxed);
+        for (uint32_t i = 0; i < arena_count; ++i)
+            m_arenas[i].reset();
+        m_arena_size = 0;
+    }
+}
+
+void ct_shared_buffers::add_arena()
+{
+    uint32_t index = m_arena_count.load(std::memory_order_relaxed);
+    CT_ASSERT(index < ct_scratch_max_arenas);
+
+    std::unique_ptr<ct_scratch_arena> arena{new ct_scratch_arena};
+    arena->m_memory.allocate(m_arena_size, ct_buffer_alignment, ct_buffer_memory_flags);
+    m_arenas[index] = std::move(arena);
+    m_arena_count.store(index + 1, std::memory_order_release);
+}
+
+ct_scratch_arena *ct_shared_buffers::claim() noexcept
+{
+    CT_ASSERT(ct_is_audio_thread());
+
+    static thread_local uint32_t last_index = 0;
+
+    uint32_t arena_count = m_arena_count.load(std::memory_order_acquire);
+    for (uint32_t i = 0; i < arena_count; ++i) {
+        uint32_t index = (last_index + i) % arena_count;
+        ct_scratch_arena *arena = m_arenas[index].get();
+        if (!arena->m_busy.load(std::memory_order_relaxed) &&
+            !arena->m_busy.exchange(true, std::memory_order_acquire))
+        {
+            last_index = index;
+            return arena;
+        }
+    }
+
+    return nullptr;
+}
+
+void ct_shared_buffers::report_footprint()
+{
+    std::lock_guard<std::mutex> lock{m_mutex};
+
+    std::shared_ptr<rt_memory> zero = m_zero.lock();
+    size_t zero_size = zero ? zero->size() : 0;
+    uint32_t arena_count = m_arena_count.load(std::memory_order_relaxed);
+    size_t shared_size = zero_size + arena_count * m_arena_size;
+
+    CT_MESSAGE("Buffer footprint of ", m_users, " instances");
+    CT_MESSAGE_NP(CT_MESSAGE_PREFIX_SPACES, "Shared: ", shared_size, " bytes (zero ", zero_size, ", ", arena_count, " arenas of ", m_arena_size, ")");
+    CT_MESSAGE_NP(CT_MESSAGE_PREFIX_SPACES, "Unshared: ", m_unshared_size, " bytes");
+}
+
+} // namespace ct
@@ -0,0 +1,79 @@
+#pragma once
+#include "ct_defs.hpp"
+#include "utility/ct_rt_memory.hpp"
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace ct {
+
+struct ct_scratch_arena {
+    std::atomic<bool> m_busy{false};
+    rt_memory m_memory;
+};
+
+// The buffers shared by the instances of the process, which would otherwise be
+// duplicated in each of them, using memory and polluting the cache.
+// - the zero region is shared by all instances, and its pages are protected
+//   from writing, so a plugin which writes into a silent input faults at the
+//   write, instead of corrupting the silence of the others. It's reference
+//   counted, and replaced by a larger one when an instance requires more; the
+//   instances which hold the previous one keep it until they release it.
+// - the scratch arenas hold the transient buffers of processing, and each is
+//   used by a single audio thread at a time. There are as many as instances,
+//   so that a claim does not fail, and a thread claims again the arena it
+//   used last if possible, so that it stays in the cache. They are allocated
+//   by the main thread only.
+class ct_shared_buffers {
+public:
+    static ct_shared_buffers &instance();
+
+    // [main-thread] register an instance, which requires a zero region and a
+    // scratch arena of the sizes given, and get the zero region
+    std::shared_ptr<const rt_memory> attach(size_t zero_size, size_t scratch_size);
+    // [main-thread] unregister an instance, with the sizes given to `attach`
+    void detach(size_t zero_size, size_t scratch_size);
+
+    // [audio-thread] claim a scratch arena, or get null if none is available,
+    // which happens only past `ct_scratch_max_arenas` threads at once
+    ct_scratch_arena *claim() noexcept;
+    // [audio-thread] release an arena returned by `claim`
+    void release(ct_scratch_arena *arena) noexcept { arena->m_busy.store(false, std::memory_order_release); }
+
+    // [main-thread] print the memory of the shared buffers, compared with the
+    // memory which the instances would allocate if they did not share
+    void report_footprint();
+
+private:
+    ct_shared_buffers() = default;
+    void add_arena();
+
+private:
+    std::mutex m_mutex;
+    std::weak_ptr<rt_memory> m_zero;
+    std::unique_ptr<ct_scratch_arena> m_arenas[ct_scratch_max_arenas];
+    std::atomic<uint32_t> m_arena_count{0};
+    size_t m_arena_size = 0;
+    uint32_t m_users = 0;
+    size_t m_unshared_size = 0;
+};
+
+// A scratch arena claimed for the duration of the scope
+class ct_scratch_lease {
+public:
+    ct_scratch_lease() noexcept : m_arena{ct_shared_buffers::instance().claim()} {}
+    ~ct_scratch_lease() noexcept { if (m_arena) ct_shared_buffers::instance().release(m_arena); }
+    explicit operator bool() const noexcept { return m_arena != nullptr; }
+    uint8_t *data() const noexcept { return m_arena->m_memory.data(); }
+
+private:
+    ct_scratch_lease(const ct_scratch_lease &) = delete;
+    ct_scratch_lease &operator=(const ct_scratch_lease &) = delete;
+
+private:
+    ct_scratch_arena *m_arena = nullptr;
+};
+
+} // namespace ct
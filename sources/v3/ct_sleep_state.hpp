@@ -0,0 +1,61 @@
+#pragma once
+#include <clap/clap.h>
+#include <cstdint>
+
+namespace ct {
+
+// Follows the status returned by the plugin processing, to determine when the
+// plugin may sleep, so that the wrapper skips processing until it has input.
+// - CLAP_PROCESS_SLEEP: sleep right away
+// - CLAP_PROCESS_CONTINUE_IF_NOT_QUIET: sleep once the output is quiet
+// - CLAP_PROCESS_TAIL: sleep once the input has been quiet for the tail length
+// The plugin wakes up on input events, or input which is not quiet.
+class ct_sleep_state {
+public:
+    void reset() noexcept { *this = ct_sleep_state{}; }
+    bool is_sleeping() const noexcept { return m_sleeping; }
+    void wake() noexcept { m_sleeping = false; m_in_tail = false; }
+
+    // whether the next update needs to know if the input is quiet
+    bool tracks_input() const noexcept { return m_in_tail; }
+
+    // [audio-thread] update after processing a block
+    // `input_quiet` is measured before processing, if `tracks_input()`
+    // `tail` is given by the plugin, or zero if it does not have the extension
+    void update(clap_process_status status, bool input_quiet, bool output_quiet, uint32_t tail, uint32_t nframes) noexcept;
+
+private:
+    bool m_sleeping = false;
+    bool m_in_tail = false;
+    uint32_t m_tail_left = 0;
+};
+
+//------------------------------------------------------------------------------
+inline void ct_sleep_state::update(clap_process_status status, bool input_quiet, bool output_quiet, uint32_t tail, uint32_t nframes) noexcept
+{
+    switch (status) {
+    case CLAP_PROCESS_SLEEP:
+        m_sleeping = true;
+        m_in_tail = false;
+        break;
+    case CLAP_PROCESS_CONTINUE_IF_NOT_QUIET:
+        m_sleeping = output_quiet;
+        m_in_tail = false;
+        break;
+    case CLAP_PROCESS_TAIL:
+        // the tail counts from the end of the input, an infinite tail never ends
+        if (!m_in_tail || !input_quiet || tail >= (uint32_t)INT32_MAX)
+            m_tail_left = tail;
+        else
+            m_tail_left = (m_tail_left > nframes) ? (m_tail_left - nframes) : 0;
+        m_sleeping = m_in_tail && input_quiet && m_tail_left == 0;
+        m_in_tail = !m_sleeping;
+        break;
+    default:
+        m_sleeping = false;
+        m_in_tail = false;
+        break;
+    }
+}
+
+} // namespace ct
@@ -0,0 +1,305 @@
+#include "ct_thread_pool.hpp"
+#include "ct_threads.hpp"
+#include "utility/ct_assert.hpp"
+#include "utility/ct_messages.hpp"
+#include <algorithm>
+#include <chrono>
+#if defined(_WIN32)
+#   include <windows.h>
+#else
+#   include <pthread.h>
+#   include <sched.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_IX86)
+#   include <emmintrin.h>
+#endif
+
+namespace ct {
+
+// the time an idle worker spins before it sleeps, and the spins between the
+// reads of the clock; it's only a delay, since the requester executes tasks
+static constexpr std::chrono::microseconds worker_spin_time{20};
+static constexpr uint32_t worker_spins_per_check = 64;
+
+static thread_local uint32_t requester_session = 0;
+
+static inline void cpu_relax() noexcept
+{
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_IX86)
+    _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+// the real-time priority of the calling thread, or 0 if it's not real-time
+static int get_current_priority() noexcept
+{
+#if defined(_WIN32)
+    int priority = GetThreadPriority(GetCurrentThread());
+    return (priority != THREAD_PRIORITY_ERROR_RETURN) ? std::max(priority, 0) : 0;
+#else
+    int policy = SCHED_OTHER;
+    sched_param param{};
+    if (pthread_getschedparam(pthread_self(), &policy, &param) != 0)
+        return 0;
+    return (policy == SCHED_FIFO || policy == SCHED_RR) ? param.sched_priority : 0;
+#endif
+}
+
+// set the calling thread to the given priority, as returned by the above
+static bool set_current_priority(int priority) noexcept
+{
+#if defined(_WIN32)
+    return SetThreadPriority(GetCurrentThread(), priority) != 0;
+#else
+    sched_param param{};
+    param.sched_priority = priority;
+    return pthread_setschedparam(pthread_self(), (priority > 0) ? SCHED_FIFO : SCHED_OTHER, &param) == 0;
+#endif
+}
+
+//------------------------------------------------------------------------------
+ct_thread_pool &ct_thread_pool::instance()
+{
+    static ct_thread_pool pool;
+    return pool;
+}
+
+void ct_thread_pool::attach()
+{
+    CT_ASSERT(ct_is_main_thread());
+
+    std::lock_guard<std::mutex> lock{m_mutex};
+
+    if (m_users++ > 0)
+        return;
+
+    // the audio thread is the other one, which takes part in requests
+    uint32_t num_processors = std::max(std::thread::hardware_concurrency(), 1u);
+    uint32_t num_workers = num_processors - 1;
+
+    // the workers start at normal priority, until a request tells theirs
+    ++m_session;
+    m_priority.store(-1, std::memory_order_relaxed);
+    m_priority_failed.store(false, std::memory_order_relaxed);
+
+    m_stop.store(false, std::memory_order_relaxed);
+    m_workers.reserve(num_workers);
+    for (uint32_t i = 0; i < num_workers; ++i)
+        m_workers.emplace_back([this, i]() { run_worker(i); });
+
+    m_num_workers.store(num_workers, std::memory_order_relaxed);
+}
+
+void ct_thread_pool::detach()
+{
+    CT_ASSERT(ct_is_main_thread());
+
+    std::lock_guard<std::mutex> lock{m_mutex};
+
+    if (--m_users > 0)
+        return;
+
+    m_num_workers.store(0, std::memory_order_relaxed);
+    m_stop.store(true, std::memory_order_seq_cst);
+    wake_workers();
+    for (std::thread &worker : m_workers)
+        worker.join();
+    m_workers.clear();
+
+    if (m_priority_failed.load(std::memory_order_relaxed))
+        CT_WARNING("Cannot set the real-time priority of the thread pool");
+}
+
+void ct_thread_pool::execute(const clap_plugin *plugin, const clap_plugin_thread_pool *ext, uint32_t num_tasks) noexcept
+{
+    CT_ASSERT(ct_is_audio_thread());
+
+    if (num_tasks == 0)
+        return;
+
+    // once for each thread, since the workers were started
+    if (requester_session != m_session) {
+        requester_session = m_session;
+        adopt_requester_priority();
+    }
+
+    // find a free slot, or execute everything in this thread if there is none
+    ct_thread_pool_job *job = nullptr;
+    if (num_tasks > 1 && m_num_workers.load(std::memory_order_relaxed) > 0) {
+        for (uint32_t i = 0; !job && i < ct_thread_pool_max_jobs; ++i) {
+            uint32_t state = ct_thread_pool_job::job_free;
+            if (m_jobs[i].m_state.compare_exchange_strong(state, ct_thread_pool_job::job_filling, std::memory_order_acquire, std::memory_order_relaxed))
+                job = &m_jobs[i];
+        }
+    }
+    if (!job) {
+        for (uint32_t i = 0; i < num_tasks; ++i)
+            CLAP_CALL(ext, exec, plugin, i);
+        return;
+    }
+
+    job->m_plugin = plugin;
+    job->m_ext = ext;
+    job->m_num_tasks = num_tasks;
+    job->m_next_task.store(0, std::memory_order_relaxed);
+    job->m_done_tasks.store(0, std::memory_order_relaxed);
+    job->m_state.store(ct_thread_pool_job::job_open, std::memory_order_seq_cst);
+    wake_workers();
+
+    // take part, then wait for the tasks which the workers have started
+    run_tasks(*job);
+    while (job->m_done_tasks.load(std::memory_order_acquire) < num_tasks)
+        cpu_relax();
+
+    // close the slot, once no helper reads it anymore
+    job->m_state.store(ct_thread_pool_job::job_closing, std::memory_order_seq_cst);
+    while (job->m_helpers.load(std::memory_order_seq_cst) > 0)
+        cpu_relax();
+    job->m_state.store(ct_thread_pool_job::job_free, std::memory_order_release);
+}
+
+void ct_thread_pool::run_tasks(ct_thread_pool_job &job) noexcept
+{
+    uint32_t num_tasks = job.m_num_tasks;
+    uint32_t count = 0;
+#if CT_RT_AUDIT
+    rt_audit_scope audit;
+#endif
+
+    for (;;) {
+        // check first, to not contend on the counter once the tasks are taken
+        if (job.m_next_task.load(std::memory_order_relaxed) >= num_tasks)
+            break;
+        uint32_t task_index = job.m_next_task.fetch_add(1, std::memory_order_relaxed);
+        if (task_index >= num_tasks)
+            break;
+        CLAP_CALL(job.m_ext, exec, job.m_plugin, task_index);
+        ++count;
+    }
+
+    if (count > 0)
+        job.m_done_tasks.fetch_add(count, std::memory_order_release);
+}
+
+bool ct_thread_pool::help(uint32_t first_job) noexcept
+{
+    bool found = false;
+
+    for (uint32_t i = 0; i < ct_thread_pool_max_jobs; ++i) {
+        ct_thread_pool_job &job = m_jobs[(first_job + i) % ct_thread_pool_max_jobs];
+        if (job.m_state.load(std::memory_order_relaxed) != ct_thread_pool_job::job_open)
+            continue;
+
+        // hold the slot, then check that it's still open, and not refilled
+        job.m_helpers.fetch_add(1, std::memory_order_seq_cst);
+        if (job.m_state.load(std::memory_order_seq_cst) == ct_thread_pool_job::job_open &&
+            job.m_next_task.load(std::memory_order_relaxed) < job.m_num_tasks)
+        {
+            run_tasks(job);
+            found = true;
+        }
+        job.m_helpers.fetch_sub(1, std::memory_order_release);
+    }
+
+    return found;
+}
+
+bool ct_thread_pool::has_open_job() const noexcept
+{
+    for (const ct_thread_pool_job &job : m_jobs) {
+        if (job.m_state.load(std::memory_order_seq_cst) == ct_thread_pool_job::job_open)
+            return true;
+    }
+    return false;
+}
+
+bool ct_thread_pool::spin_for_job() const noexcept
+{
+    auto deadline = std::chrono::steady_clock::now() + worker_spin_time;
+    do {
+        for (uint32_t i = 0; i < worker_spins_per_check; ++i) {
+            if (has_open_job())
+                return true;
+            cpu_relax();
+        }
+    } while (std::chrono::steady_clock::now() < deadline);
+    return false;
+}
+
+// the sleepers are counted before they check for work, and the waker takes
+// the count, posting once for each; so a request either is seen by a worker
+// about to sleep, or posts it, and no wakeup is lost
+void ct_thread_pool::wake_workers() noexcept
+{
+    if (m_sleepers.load(std::memory_order_seq_cst) == 0)
+        return;
+
+    uint32_t count = m_sleepers.exchange(0, std::memory_order_seq_cst);
+    m_wakeup.post(count);
+}
+
+// uncount a worker which does not sleep after all, or return false if a waker
+// has taken the count already, then the worker has a post to consume
+bool ct_thread_pool::withdraw_sleeper() noexcept
+{
+    uint32_t count = m_sleepers.load(std::memory_order_relaxed);
+    while (count > 0) {
+        if (m_sleepers.compare_exchange_weak(count, count - 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            return true;
+    }
+    return false;
+}
+
+// the workers run at the lowest priority of the requesters
+void ct_thread_pool::adopt_requester_priority() noexcept
+{
+    int priority = get_current_priority();
+
+    int current = m_priority.load(std::memory_order_relaxed);
+    do {
+        if (current >= 0 && current <= priority)
+            return;
+    } while (!m_priority.compare_exchange_weak(current, priority, std::memory_order_relaxed));
+
+    m_priority_serial.fetch_add(1, std::memory_order_release);
+}
+
+void ct_thread_pool::update_worker_priority(uint32_t &serial) noexcept
+{
+    uint32_t current_serial = m_priority_serial.load(std::memory_order_acquire);
+    if (current_serial == serial)
+        return;
+
+    serial = current_serial;
+    int priority = m_priority.load(std::memory_order_relaxed);
+    if (priority >= 0 && !set_current_priority(priority))
+        m_priority_failed.store(true, std::memory_order_relaxed);
+}
+
+void ct_thread_pool::run_worker(uint32_t index)
+{
+    // each worker starts looking at a different slot, spreading the workers
+    // over the requests of several instances
+    uint32_t first_job = index % ct_thread_pool_max_jobs;
+    uint32_t priority_serial = m_priority_serial.load(std::memory_order_relaxed);
+
+    // the tasks run with the role of the thread which requests them
+    ct_thread_roles |= ct_thread_role_audio;
+
+    while (!m_stop.load(std::memory_order_relaxed)) {
+        update_worker_priority(priority_serial);
+
+        if (help(first_job) || spin_for_job())
+            continue;
+
+        m_sleepers.fetch_add(1, std::memory_order_seq_cst);
+        if (!has_open_job() && !m_stop.load(std::memory_order_seq_cst))
+            m_wakeup.wait();
+        else if (!withdraw_sleeper())
+            m_wakeup.wait();
+    }
+}
+
+} // namespace ct
@@ -0,0 +1,80 @@
+#pragma once
+#include "ct_defs.hpp"
+#include "utility/ct_semaphore.hpp"
+#include <clap/clap.h>
+#include <thread>
+#include <mutex>
+#include <vector>
+#include <atomic>
+#include <cstdint>
+
+namespace ct {
+
+// A request of the plugin to execute tasks, which the workers take part in.
+// The slot is reused after the request completes; the helpers are counted,
+// so that the requester knows when nobody reads it anymore.
+struct alignas(ct_cache_line_size) ct_thread_pool_job {
+    enum : uint32_t { job_free, job_filling, job_open, job_closing };
+    std::atomic<uint32_t> m_state{job_free};
+    std::atomic<uint32_t> m_helpers{0};
+    const clap_plugin *m_plugin = nullptr;
+    const clap_plugin_thread_pool *m_ext = nullptr;
+    uint32_t m_num_tasks = 0;
+    alignas(ct_cache_line_size) std::atomic<uint32_t> m_next_task{0};
+    alignas(ct_cache_line_size) std::atomic<uint32_t> m_done_tasks{0};
+};
+
+// The workers which execute the tasks of `clap.thread-pool`, shared by all the
+// instances of the process, with one per processor besides the audio thread.
+// - the requesting thread executes tasks too, and only waits for those which
+//   the workers have started, so a request completes even if all the workers
+//   are busy, or if it's made from within a task.
+// - the workers steal tasks from any open request, by claiming the next index
+//   atomically; they spin for a few microseconds when idle, then sleep until
+//   a request posts them.
+// - the workers take the priority of the threads which request tasks, the
+//   lowest of them, so that they never preempt the audio threads of the host.
+class ct_thread_pool {
+public:
+    static ct_thread_pool &instance();
+
+    // [main-thread] register an instance, starting the workers with the first
+    void attach();
+    // [main-thread] unregister an instance, stopping the workers with the last
+    void detach();
+
+    // [audio-thread] execute the tasks of the plugin, and return once all are
+    // complete
+    void execute(const clap_plugin *plugin, const clap_plugin_thread_pool *ext, uint32_t num_tasks) noexcept;
+
+private:
+    ct_thread_pool() = default;
+    void run_worker(uint32_t index);
+    bool help(uint32_t first_job) noexcept;
+    bool has_open_job() const noexcept;
+    bool spin_for_job() const noexcept;
+    void wake_workers() noexcept;
+    bool withdraw_sleeper() noexcept;
+    void adopt_requester_priority() noexcept;
+    void update_worker_priority(uint32_t &serial) noexcept;
+    static void run_tasks(ct_thread_pool_job &job) noexcept;
+
+private:
+    std::mutex m_mutex;
+    uint32_t m_users = 0;
+    std::vector<std::thread> m_workers;
+    std::atomic<uint32_t> m_num_workers{0};
+    std::atomic<bool> m_stop{false};
+    uint32_t m_session = 0;
+
+    rt_semaphore m_wakeup;
+    std::atomic<uint32_t> m_sleepers{0};
+
+    std::atomic<int> m_priority{-1}; // of the workers, 0 if not real-time
+    std::atomic<uint32_t> m_priority_serial{0};
+    std::atomic<bool> m_priority_failed{false};
+
+    ct_thread_pool_job m_jobs[ct_thread_pool_max_jobs];
+};
+
+} // namespace ct
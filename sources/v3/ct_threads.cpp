@@ -3,14 +3,21 @@
 
 #if CT_X11
 static std::recursive_mutex main_thread_guard_mutex;
+#endif
 
 main_thread_guard::main_thread_guard()
+    : m_saved_roles{ct::ct_thread_roles}
 {
+#if CT_X11
     main_thread_guard_mutex.lock();
+#endif
+    ct::ct_thread_roles |= ct::ct_thread_role_main;
 }
 
 main_thread_guard::~main_thread_guard()
 {
+    ct::ct_thread_roles = m_saved_roles;
+#if CT_X11
     main_thread_guard_mutex.unlock();
-}
 #endif
+}
@@ -1,5 +1,6 @@
 #pragma once
 #include "ct_defs.hpp"
+#include <cstdint>
 
 // Provides some limited thread-safety on X11.
 // This problem does not exist on Windows and MacOS platforms.
@@ -9,9 +10,45 @@
 // [main-thread] role, potentially concurrently.
 // The problem is partially mitigated by setting mutex guards at strategic
 // positions. (eg. timer/event handler entries, component activation)
+// On all platforms, the guard tags the thread with the [main-thread] role.
 struct main_thread_guard {
-#if CT_X11
     main_thread_guard();
     ~main_thread_guard();
-#endif
+
+private:
+    uint32_t m_saved_roles = 0;
+};
+
+namespace ct {
+
+// The roles of the current thread, as known by the wrapper, which answers the
+// `clap.thread-check` of the plugin, and checks itself in debug builds.
+// - main: the thread which creates the components, the thread of the run
+//   loop, and any thread in a timer or fd callback, or under a guard
+// - audio: any thread in `process`, and the workers of the thread pool
+// The tags are thread-local, and reading them costs a memory access.
+enum ct_thread_role : uint32_t {
+    ct_thread_role_main = 1u << 0,
+    ct_thread_role_audio = 1u << 1,
 };
+
+inline thread_local uint32_t ct_thread_roles = 0;
+
+inline bool ct_is_main_thread() noexcept { return (ct_thread_roles & ct_thread_role_main) != 0; }
+inline bool ct_is_audio_thread() noexcept { return (ct_thread_roles & ct_thread_role_audio) != 0; }
+
+// Tags the current thread with roles, for the duration of the scope
+class ct_thread_role_scope {
+public:
+    explicit ct_thread_role_scope(uint32_t roles) noexcept : m_saved{ct_thread_roles} { ct_thread_roles = m_saved | roles; }
+    ~ct_thread_role_scope() noexcept { ct_thread_roles = m_saved; }
+
+private:
+    ct_thread_role_scope(const ct_thread_role_scope &) = delete;
+    ct_thread_role_scope &operator=(const ct_thread_role_scope &) = delete;
+
+private:
+    uint32_t m_saved = 0;
+};
+
+} // namespace ct
@@ -105,3 +105,16 @@ struct timer_handler {
 };
 
 } // namespace v3
+
+namespace ct {
+
+// the channel buffers of an audio bus, by sample type
+template <class T> T **&v3_buffer_ptrs(v3_audio_bus_buffers &ab);
+template <> inline float **&v3_buffer_ptrs<float>(v3_audio_bus_buffers &ab) { return ab.channel_buffers_32; }
+template <> inline double **&v3_buffer_ptrs<double>(v3_audio_bus_buffers &ab) { return ab.channel_buffers_64; }
+
+template <class T> T **v3_buffer_ptrs(const v3_audio_bus_buffers &ab);
+template <> inline float **v3_buffer_ptrs<float>(const v3_audio_bus_buffers &ab) { return ab.channel_buffers_32; }
+template <> inline double **v3_buffer_ptrs<double>(const v3_audio_bus_buffers &ab) { return ab.channel_buffers_64; }
+
+} // namespace ct